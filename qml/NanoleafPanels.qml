@@ -0,0 +1,65 @@
+import QtQuick 2.15
+import QtQuick.Shapes 1.15
+import VCStyles 1.0
+import com.benprisby.vc.vchub 1.0
+
+Item {
+    id: root
+
+    property bool selected: false
+
+    signal clicked()
+
+    width: (panelsRepeater.count > 0) ? 96 : fallbackDot.width
+    height: (panelsRepeater.count > 0) ? (width / VCHub.nanoleaf.layout.aspectRatio) : fallbackDot.height
+
+    // Until the layout is known, show a plain dot.
+    DeviceDot {
+        id: fallbackDot
+
+        anchors.centerIn: parent
+        visible: panelsRepeater.count === 0
+        selected: root.selected
+        color: VCHub.nanoleaf.isOn ? VCColor.green : VCColor.grayLighter
+        onClicked: root.clicked()
+    }
+
+    Repeater {
+        id: panelsRepeater
+
+        model: VCHub.nanoleaf.layout
+
+        delegate: Shape {
+            width: root.width
+            height: root.height
+
+            ShapePath {
+                fillColor: {
+                    if (!VCHub.nanoleaf.isOn) {
+                        return VCColor.grayLighter;
+                    }
+                    return panelColor ? panelColor : VCColor.green;
+                }
+                strokeColor: root.selected ? VCColor.white : VCColor.grayDarker
+                strokeWidth: root.selected ? 2 : 1
+                scale: Qt.size(root.width, root.height)
+
+                PathPolyline {
+                    path: vertices
+                }
+
+            }
+
+        }
+
+    }
+
+    MouseArea {
+        id: mouseArea
+
+        anchors.fill: parent
+        enabled: panelsRepeater.count > 0
+        onClicked: root.clicked()
+    }
+
+}
@@ -0,0 +1,73 @@
+import QtQuick 2.15
+import QtQuick.Layouts 1.12
+import VCStyles 1.0
+import com.benprisby.vc.vchub 1.0
+
+Rectangle {
+    id: root
+
+    width: overlayLayout.implicitWidth + (2 * VCMargin.small)
+    height: overlayLayout.implicitHeight + (2 * VCMargin.small)
+    radius: VCMargin.tiny
+    color: Qt.rgba(0, 0, 0, 0.7)
+    visible: VCHub.profiler.overlayVisible
+
+    ColumnLayout {
+        id: overlayLayout
+
+        anchors.fill: parent
+        anchors.margins: VCMargin.small
+        spacing: VCMargin.tiny
+
+        Text {
+            id: frameRateText
+
+            font.pixelSize: VCFont.label
+            color: (VCHub.profiler.frameRate >= 50) ? VCColor.green : VCColor.yellow
+            text: qsTr("%1 FPS").arg(VCHub.profiler.frameRate.toFixed(1))
+        }
+
+        Text {
+            id: frameTimesText
+
+            font.pixelSize: VCFont.label
+            color: VCColor.white
+            text: qsTr("Sync %1 ms  Render %2 ms  Worst %3 ms").arg(VCHub.profiler.syncTime.toFixed(1)).arg(
+                      VCHub.profiler.renderTime.toFixed(1)).arg(VCHub.profiler.worstFrameTime.toFixed(1))
+        }
+
+        Text {
+            id: stallsText
+
+            font.pixelSize: VCFont.label
+            color: (VCHub.profiler.stallCount > 0) ? VCColor.orange : VCColor.white
+            text: qsTr("Stalls: %1").arg(VCHub.profiler.stallCount)
+        }
+
+        Text {
+            id: lastStallText
+
+            Layout.maximumWidth: 400
+            font.pixelSize: VCFont.label
+            elide: Text.ElideRight
+            color: VCColor.grayLightest
+            text: VCHub.profiler.lastStall
+            visible: text
+        }
+
+    }
+
+    // Tap to save what has been recorded so far as a trace.
+    MouseArea {
+        id: traceDumper
+
+        anchors.fill: parent
+        onClicked: {
+            var filename = VCHub.profiler.dumpTrace();
+            if (filename)
+                console.log("Trace: " + filename);
+
+        }
+    }
+
+}
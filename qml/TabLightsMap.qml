@@ -1,3 +1,4 @@
+import QtQml 2.12
 import QtQuick 2.15
 import VCStyles 1.0
 import com.benprisby.vc.vchub 1.0
@@ -8,7 +9,6 @@ Item {
     onVisibleChanged: {
         if (visible) {
             VCHub.hue.refreshGroups();
-            VCHub.nanoleaf.refreshEffects();
         } else {
             // Clear out any selections when navigating away from this tab.
             hueDevicesRepeater.selectedIndex = -1;
@@ -86,60 +86,15 @@ Item {
 
         }
 
-        DeviceDot {
+        NanoleafPanels {
             id: nanoleafDot
 
-            property int colorsIndex: -1
-            readonly property var colors: {
-                for (var i = 0; i < VCHub.nanoleaf.effects.length; i++) {
-                    var effect = VCHub.nanoleaf.effects[i];
-                    if ((effect.name === VCHub.nanoleaf.selectedEffect) && effect.colors) {
-                        return effect.colors;
-                    }
-                }
-                return [];
-            }
-
-            x: VCHub.nanoleaf.mapPoint[0] * floorPlanMap.width
-            y: VCHub.nanoleaf.mapPoint[1] * floorPlanMap.height
-            color: {
-                if (VCHub.nanoleaf.isOn) {
-                    if (colorsIndex >= 0) {
-                        return colors[colorsIndex];
-                    }
-                    return VCColor.green;
-                }
-                return VCColor.grayLighter;
-            }
-            onColorsChanged: {
-                if (nanoleafColorRotationTimer.running) {
-                    nanoleafColorRotationTimer.restart();
-                    colorsIndex = 0;
-                } else {
-                    colorsIndex = -1;
-                }
-            }
+            x: (VCHub.nanoleaf.mapPoint[0] * floorPlanMap.width) - (width / 2)
+            y: (VCHub.nanoleaf.mapPoint[1] * floorPlanMap.height) - (height / 2)
             onClicked: {
                 hueDevicesRepeater.selectedIndex = -1;
                 selected = true;
             }
-
-            Timer {
-                id: nanoleafColorRotationTimer
-
-                running: visible && (nanoleafDot.colors.length > 0)
-                repeat: true
-                interval: 5000
-                onTriggered: {
-                    if (nanoleafDot.colorsIndex < (nanoleafDot.colors.length - 1)) {
-                        nanoleafDot.colorsIndex++;
-                    } else {
-                        nanoleafDot.colorsIndex = 0;
-                    }
-                }
-                onRunningChanged: nanoleafDot.colorsIndex = running ? 0 : -1
-            }
-
         }
 
         SequentialAnimation {
@@ -199,4 +154,15 @@ Item {
         visible: nanoleafDot.selected
     }
 
+    // Keep the data refreshing at full rate while the map is on screen, since it is not a tile of its own.
+    Instantiator {
+        model: [VCHub.hue, VCHub.nanoleaf]
+
+        PluginViewer {
+            plugin: modelData
+            active: root.visible
+        }
+
+    }
+
 }
@@ -28,6 +28,7 @@ ColumnLayout {
 
             Layout.fillHeight: true
             Layout.preferredWidth: height
+            plugins: [VCHub.piHole]
             introAnimationDelay: 150
 
             ColumnLayout {
@@ -67,6 +68,7 @@ ColumnLayout {
 
             Layout.fillWidth: true
             Layout.fillHeight: true
+            plugins: [VCHub.piHole]
             introAnimationDelay: 50
 
             ColumnLayout {
@@ -96,7 +98,7 @@ ColumnLayout {
                     font.pixelSize: VCFont.header
                     font.bold: true
                     color: VCColor.white
-                    text: VCHub.formatInt(VCHub.piHole.totalQueries)
+                    text: VCHub.piHole.totalQueriesText
                 }
 
             }
@@ -108,6 +110,7 @@ ColumnLayout {
 
             Layout.fillWidth: true
             Layout.fillHeight: true
+            plugins: [VCHub.piHole]
             introAnimationDelay: 200
 
             ColumnLayout {
@@ -137,7 +140,7 @@ ColumnLayout {
                     font.pixelSize: VCFont.header
                     font.bold: true
                     color: VCColor.white
-                    text: VCHub.formatInt(VCHub.piHole.blockedQueries)
+                    text: VCHub.piHole.blockedQueriesText
                 }
 
             }
@@ -149,6 +152,7 @@ ColumnLayout {
 
             Layout.fillWidth: true
             Layout.fillHeight: true
+            plugins: [VCHub.piHole]
 
             ColumnLayout {
                 id: blockPercentageLayout
@@ -177,7 +181,7 @@ ColumnLayout {
                     font.pixelSize: VCFont.header
                     font.bold: true
                     color: VCColor.white
-                    text: VCHub.formatPercentage(VCHub.piHole.percentBlocked)
+                    text: VCHub.piHole.percentBlockedText
                 }
 
             }
@@ -189,6 +193,7 @@ ColumnLayout {
 
             Layout.fillWidth: true
             Layout.fillHeight: true
+            plugins: [VCHub.piHole]
             introAnimationDelay: 100
 
             ColumnLayout {
@@ -218,7 +223,7 @@ ColumnLayout {
                     font.pixelSize: VCFont.header
                     font.bold: true
                     color: VCColor.white
-                    text: VCHub.formatInt(VCHub.piHole.blockedDomains)
+                    text: VCHub.piHole.blockedDomainsText
                 }
 
             }
@@ -232,6 +237,7 @@ ColumnLayout {
 
         Layout.fillWidth: true
         Layout.fillHeight: true
+        plugins: [VCHub.piHole]
         introAnimationDelay: 250
 
         ChartView {
@@ -309,6 +315,7 @@ ColumnLayout {
 
         Layout.fillWidth: true
         Layout.fillHeight: true
+        plugins: [VCHub.piHole]
         introAnimationDelay: 300
 
         ChartView {
@@ -25,6 +25,7 @@ GridLayout {
         Layout.fillHeight: true
         Layout.preferredWidth: Layout.columnSpan
         Layout.columnSpan: 2
+        plugins: [VCHub.spotify]
 
         ColumnLayout {
             id: playerLayout
@@ -323,6 +324,7 @@ GridLayout {
         Layout.fillWidth: true
         Layout.preferredHeight: 120
         Layout.preferredWidth: Layout.columnSpan
+        plugins: [VCHub.spotify]
         introAnimationDelay: 200
 
         ColumnLayout {
@@ -526,6 +528,7 @@ GridLayout {
         Layout.fillWidth: true
         Layout.preferredHeight: 120
         Layout.preferredWidth: Layout.columnSpan
+        plugins: [VCHub.spotify]
         introAnimationDelay: 100
 
         RowLayout {
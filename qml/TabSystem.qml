@@ -414,6 +414,25 @@ GridLayout {
                     onClicked: VCHub.screensaverEnabled = checked
                 }
 
+                Text {
+                    id: profilerOverlayLabel
+
+                    Layout.fillWidth: true
+                    verticalAlignment: Text.AlignVCenter
+                    font.pixelSize: VCFont.body
+                    color: VCColor.white
+                    text: qsTr("Performance Overlay")
+                }
+
+                VCSwitch {
+                    id: profilerOverlaySwitch
+
+                    Layout.preferredWidth: width
+                    Layout.maximumHeight: 30
+                    checked: VCHub.profiler.overlayVisible
+                    onClicked: VCHub.profiler.overlayVisible = checked
+                }
+
             }
 
             Item {
@@ -1,5 +1,7 @@
+import QtQml 2.12
 import QtQuick 2.12
 import VCStyles 1.0
+import com.benprisby.vc.vchub 1.0
 
 Rectangle {
     id: root
@@ -7,6 +9,8 @@ Rectangle {
     property bool introAnimationEnabled: true
     property int introAnimationDuration: 500
     property int introAnimationDelay: 0
+    property var plugins: []  // Whose data is shown, kept refreshing at the full rate while the tile is visible
+    property bool available: plugins.every((plugin) => plugin.isReachable)  // Greyed out otherwise
 
     radius: 6
     opacity: 0
@@ -20,6 +24,37 @@ Rectangle {
         }
     }
 
+    // Grey out over the content, so nothing has to be hidden while offline.
+    Rectangle {
+        id: unavailableOverlay
+
+        z: 10
+        anchors.fill: parent
+        radius: root.radius
+        color: VCColor.black
+        opacity: root.available ? 0 : 0.6
+        visible: opacity > 0
+
+        Behavior on opacity {
+            NumberAnimation {
+                duration: 500
+                easing.type: Easing.InOutQuad
+            }
+
+        }
+
+    }
+
+    Instantiator {
+        model: root.plugins
+
+        PluginViewer {
+            plugin: modelData
+            active: root.visible
+        }
+
+    }
+
     SequentialAnimation {
         id: introAnimation
 
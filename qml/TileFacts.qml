@@ -7,6 +7,8 @@ import com.benprisby.vc.vchub 1.0
 Tile {
     id: root
 
+    plugins: [VCHub.facts]
+
     Flickable {
         id: flickableWrapper
 
@@ -1,12 +1,15 @@
 import QtQuick 2.15
 import QtQuick.Layouts 1.12
 import VCStyles 1.0
+import com.benprisby.vc.vchub 1.0
 
 Tile {
     id: root
 
     property var device: null
 
+    plugins: [VCHub.hue]
+
     Text {
         id: deviceName
 
@@ -69,6 +72,18 @@ Tile {
         visible: root.device && (!root.device["isReachable"])
     }
 
+    Text {
+        id: notRespondingWarning
+
+        anchors.verticalCenter: powerSwitch.verticalCenter
+        anchors.right: powerSwitch.left
+        anchors.rightMargin: VCMargin.medium
+        font: notReachableWarning.font
+        color: VCColor.red
+        text: qsTr("Not Responding")
+        visible: root.device && root.device["isReachable"] && (root.device["commands"].failedKeys.length > 0)
+    }
+
     GridLayout {
         id: controlsLayout
 
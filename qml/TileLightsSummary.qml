@@ -6,6 +6,9 @@ import com.benprisby.vc.vchub 1.0
 Tile {
     id: root
 
+    plugins: [VCHub.hue, VCHub.nanoleaf]
+    available: plugins.some((plugin) => plugin.isReachable)  // Either is enough to show something
+
     GridLayout {
         id: contentLayout
 
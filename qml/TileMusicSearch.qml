@@ -7,6 +7,7 @@ import com.benprisby.vc.vchub 1.0
 Tile {
     id: root
 
+    plugins: [VCHub.spotify]
     onVisibleChanged: {
         if (!visible) {
             searchField.text = "";
@@ -74,7 +75,7 @@ Tile {
             Layout.fillWidth: true
             Layout.fillHeight: true
             spacing: VCMargin.small
-            cacheBuffer: Math.max(0, contentHeight)
+            cacheBuffer: height  // Only so much ahead, so further pages are fetched as they scroll into view
             interactive: contentHeight > height
             clip: true
             model: VCHub.spotify.searchResults
@@ -95,7 +96,7 @@ Tile {
                     Layout.fillHeight: true
                     Layout.preferredWidth: height
                     fillMode: Image.PreserveAspectFit
-                    source: modelData["image"]
+                    source: model.image
                 }
 
                 ColumnLayout {
@@ -109,7 +110,7 @@ Tile {
                         Layout.fillWidth: true
                         font.pixelSize: VCFont.body
                         color: VCColor.white
-                        text: modelData["name"]
+                        text: model.name
                     }
 
                     Text {
@@ -119,7 +120,7 @@ Tile {
                         font.pixelSize: VCFont.label
                         color: VCColor.white
                         elide: Text.ElideRight
-                        text: modelData["artist"] + " — " + modelData["album"]
+                        text: model.artist + " — " + model.album
                     }
 
                 }
@@ -136,7 +137,7 @@ Tile {
                     text: qsTr("Queue")
                     enabled: VCHub.spotify.isPlayerActive && !queued
                     onClicked: {
-                        VCHub.spotify.queue(modelData["uri"]);
+                        VCHub.spotify.queue(model.uri);
                         queued = true;
                         text = qsTr("Queued");
                     }
@@ -7,6 +7,8 @@ import com.benprisby.vc.vchub 1.0
 Tile {
     id: root
 
+    plugins: [VCHub.nanoleaf]
+
     Text {
         id: productName
 
@@ -44,6 +46,20 @@ Tile {
         onClicked: VCHub.nanoleaf.commandPower(checked)
     }
 
+    Text {
+        id: notRespondingWarning
+
+        anchors.verticalCenter: powerSwitch.verticalCenter
+        anchors.right: powerSwitch.left
+        anchors.rightMargin: VCMargin.medium
+        font.pixelSize: VCFont.label
+        font.capitalization: Font.AllUppercase
+        font.bold: true
+        color: VCColor.red
+        text: qsTr("Not Responding")
+        visible: VCHub.nanoleaf.commands.failedKeys.length > 0
+    }
+
     ListView {
         id: effectsView
 
@@ -65,9 +81,14 @@ Tile {
         }
 
         delegate: Rectangle {
+            id: effectDelegate
+
+            readonly property string effectName: model.name
+            readonly property var effectColors: model.colors
+
             width: (effectsView.width / 4) - effectsView.spacing
             height: effectsView.height - (effectsView.interactive ? VCMargin.medium : 0)  // Leave room for the scrollbar
-            color: (modelData["name"] === VCHub.nanoleaf.selectedEffect) ? VCColor.green : VCColor.grayLight
+            color: (effectDelegate.effectName === VCHub.nanoleaf.selectedEffect) ? VCColor.green : VCColor.grayLight
             radius: 4
 
             Text {
@@ -84,9 +105,9 @@ Tile {
                 wrapMode: Text.WordWrap
                 elide: Text.ElideRight
                 font.pixelSize: VCFont.paragraph
-                font.bold: modelData["name"] === VCHub.nanoleaf.selectedEffect
+                font.bold: effectDelegate.effectName === VCHub.nanoleaf.selectedEffect
                 color: VCColor.white
-                text: modelData["name"]
+                text: effectDelegate.effectName
             }
 
             Rectangle {
@@ -105,7 +126,7 @@ Tile {
                     anchors.fill: parent
                     orientation: ListView.Horizontal
                     interactive: false
-                    model: modelData["colors"]
+                    model: effectDelegate.effectColors
 
                     delegate: Rectangle {
                         width: colorsView.width / colorsView.count
@@ -131,7 +152,7 @@ Tile {
                 id: effectsDelegateMouseArea
 
                 anchors.fill: parent
-                onClicked: VCHub.nanoleaf.selectEffect(modelData["name"])
+                onClicked: VCHub.nanoleaf.selectEffect(effectDelegate.effectName)
             }
 
         }
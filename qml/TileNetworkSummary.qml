@@ -6,6 +6,8 @@ import com.benprisby.vc.vchub 1.0
 Tile {
     id: root
 
+    plugins: [VCHub.piHole]
+
     Image {
         id: networkIcon
 
@@ -69,7 +71,7 @@ Tile {
 
             color: VCColor.green
             font.pixelSize: VCFont.body
-            text: qsTr(VCHub.formatInt(VCHub.piHole.totalQueries - VCHub.piHole.blockedQueries) + " Sent")
+            text: qsTr(VCHub.piHole.sentQueriesText + " Sent")
         }
 
         Text {
@@ -77,7 +79,7 @@ Tile {
 
             color: VCColor.red
             font.pixelSize: VCFont.body
-            text: qsTr(VCHub.formatInt(VCHub.piHole.blockedQueries) + " Blocked")
+            text: qsTr(VCHub.piHole.blockedQueriesText + " Blocked")
         }
 
         Rectangle {
@@ -102,7 +104,7 @@ Tile {
 
             color: VCColor.white
             font.pixelSize: VCFont.body
-            text: qsTr(VCHub.formatInt(VCHub.piHole.blockedDomains) + " Domains")
+            text: qsTr(VCHub.piHole.blockedDomainsText + " Domains")
         }
 
     }
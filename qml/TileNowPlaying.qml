@@ -6,6 +6,8 @@ import com.benprisby.vc.vchub 1.0
 Tile {
     id: root
 
+    plugins: [VCHub.spotify]
+
     RowLayout {
         id: contentLayout
 
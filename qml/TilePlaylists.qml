@@ -9,6 +9,7 @@ Tile {
 
     signal played()
 
+    plugins: [VCHub.spotify]
     onVisibleChanged: {
         if (visible) {
             VCHub.spotify.refreshPlaylists();
@@ -21,7 +22,7 @@ Tile {
         anchors.fill: parent
         anchors.margins: VCMargin.small
         spacing: VCMargin.small
-        cacheBuffer: Math.max(0, contentHeight)
+        cacheBuffer: height  // Only so much ahead, so further pages are fetched as they scroll into view
         interactive: contentHeight > height
         model: VCHub.spotify.playlists
 
@@ -40,7 +41,7 @@ Tile {
                 Layout.fillHeight: true
                 Layout.preferredWidth: height
                 fillMode: Image.PreserveAspectFit
-                source: modelData["image"]
+                source: model.image
             }
 
             Text {
@@ -51,7 +52,7 @@ Tile {
                 verticalAlignment: Text.AlignVCenter
                 font.pixelSize: VCFont.body
                 color: VCColor.white
-                text: modelData["name"]
+                text: model.name
             }
 
             Text {
@@ -61,7 +62,7 @@ Tile {
                 verticalAlignment: Text.AlignVCenter
                 font.pixelSize: VCFont.label
                 color: VCColor.white
-                text: modelData["trackCount"] + qsTr(" Tracks")
+                text: model.trackCount + qsTr(" Tracks")
             }
 
             Image {
@@ -71,13 +72,13 @@ Tile {
                 Layout.preferredHeight: width
                 Layout.alignment: Qt.AlignVCenter
                 sourceSize: Qt.size(Layout.preferredWidth, Layout.preferredHeight)
-                source: modelData["isPublic"] ? "qrc:/images/globe.svg" : "qrc:/images/padlock.svg"
+                source: model.isPublic ? "qrc:/images/globe.svg" : "qrc:/images/padlock.svg"
             }
 
             VCButton {
                 id: playButton
 
-                readonly property bool isCurrentPlaylist: modelData["name"] === VCHub.spotify.playlistName
+                readonly property bool isCurrentPlaylist: model.name === VCHub.spotify.playlistName
 
                 Layout.preferredWidth: 80
                 Layout.preferredHeight: 40
@@ -93,7 +94,7 @@ Tile {
                             VCHub.spotify.play();
                         }
                     } else {
-                        VCHub.spotify.play(modelData["uri"]);
+                        VCHub.spotify.play(model.uri);
                     }
                     root.played();
                 }
@@ -7,6 +7,8 @@ import com.benprisby.vc.vchub 1.0
 Tile {
     id: root
 
+    plugins: [VCHub.weather]
+
     ColumnLayout {
         id: contentLayout
 
@@ -223,7 +225,7 @@ Tile {
                     horizontalAlignment: Text.AlignHCenter
                     font.pixelSize: VCFont.label
                     color: VCColor.white
-                    text: VCHub.weather.localHour(modelData["time"])
+                    text: model.timeLabel
                 }
 
                 Image {
@@ -234,7 +236,7 @@ Tile {
                     Layout.alignment: Qt.AlignHCenter
                     fillMode: Image.PreserveAspectFit
                     sourceSize: Qt.size(width, height)
-                    source: VCHub.weather.iconURL(modelData["iconKey"])
+                    source: VCHub.weather.iconURL(model.iconKey)
                 }
 
                 Text {
@@ -245,7 +247,7 @@ Tile {
                     font.pixelSize: VCFont.label
                     font.bold: true
                     color: VCColor.white
-                    text: Math.round(modelData["temperature"]) + "°F"
+                    text: Math.round(model.temperature) + "°F"
                 }
 
             }
@@ -284,7 +286,7 @@ Tile {
                     verticalAlignment: Text.AlignVCenter
                     font.pixelSize: VCFont.paragraph
                     color: VCColor.white
-                    text: qsTr(VCHub.dayOfWeek(modelData["time"]))
+                    text: qsTr(model.timeLabel)
                 }
 
                 Image {
@@ -295,7 +297,7 @@ Tile {
                     Layout.alignment: Qt.AlignVCenter
                     fillMode: Image.PreserveAspectFit
                     sourceSize: Qt.size(Layout.preferredWidth, Layout.preferredHeight)
-                    source: VCHub.weather.iconURL(modelData["iconKey"])
+                    source: VCHub.weather.iconURL(model.iconKey)
                 }
 
                 Text {
@@ -305,7 +307,7 @@ Tile {
                     verticalAlignment: Text.AlignVCenter
                     font.pixelSize: VCFont.paragraph
                     color: VCColor.white
-                    text: Math.round(modelData["maxTemperature"]) + "°F"
+                    text: Math.round(model.maxTemperature) + "°F"
                 }
 
                 Text {
@@ -315,7 +317,7 @@ Tile {
                     verticalAlignment: Text.AlignVCenter
                     font.pixelSize: VCFont.paragraph
                     color: VCColor.grayLightest
-                    text: Math.round(modelData["minTemperature"]) + "°F"
+                    text: Math.round(model.minTemperature) + "°F"
                 }
 
             }
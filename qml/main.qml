@@ -103,20 +103,47 @@ Window {
             anchors.right: parent.right
             anchors.bottom: parent.bottom
             anchors.margins: VCMargin.medium
+            // Build each tab off the GUI thread the first time it is visited, and keep it around from then on.
+            onCurrentIndexChanged: children[currentIndex].active = true
 
-            TabHome {
+            Loader {
+                id: homeTab
+
+                property var warmedTabs: []
+
+                objectName: "homeTab"
+                asynchronous: true
+                source: "TabHome.qml"
+                // Compile the other tabs in the background once this is up, so the first visit to each is quick.
+                onLoaded: {
+                    for (var i = 1; i < mainContent.children.length; i++) {
+                        warmedTabs.push(Qt.createComponent(mainContent.children[i].source, Component.Asynchronous));
+                    }
+                }
             }
 
-            TabLights {
+            Loader {
+                active: false
+                asynchronous: true
+                source: "TabLights.qml"
             }
 
-            TabMusic {
+            Loader {
+                active: false
+                asynchronous: true
+                source: "TabMusic.qml"
             }
 
-            TabNetwork {
+            Loader {
+                active: false
+                asynchronous: true
+                source: "TabNetwork.qml"
             }
 
-            TabSystem {
+            Loader {
+                active: false
+                asynchronous: true
+                source: "TabSystem.qml"
             }
 
         }
@@ -171,6 +198,15 @@ Window {
             anchors.fill: parent
         }
 
+        ProfilerOverlay {
+            id: profilerOverlay
+
+            z: 100
+            anchors.top: parent.top
+            anchors.right: parent.right
+            anchors.margins: VCMargin.small
+        }
+
         // Animate background color changes.
         Behavior on color {
             ColorAnimation {
@@ -195,4 +231,11 @@ Window {
         }
     }
 
+    Shortcut {
+        id: profilerOverlayShortcut
+
+        sequence: "Ctrl+Shift+P"
+        onActivated: VCHub.profiler.overlayVisible = !VCHub.profiler.overlayVisible
+    }
+
 }
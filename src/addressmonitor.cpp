@@ -0,0 +1,100 @@
+#include "addressmonitor.h"
+
+#ifdef Q_OS_LINUX
+#include <errno.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include "logging.h"
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+AddressMonitor::AddressMonitor(QObject* parent) : QObject(parent), socket_(-1), notifier_(nullptr) {
+#ifdef Q_OS_LINUX
+    socket_ = ::socket(AF_NETLINK, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_ROUTE);
+    if (socket_ < 0) {
+        qCWarning(lcHub) << "Failed to open netlink socket: " << strerror(errno);
+        return;
+    }
+
+    // Only IPv4 addresses are shown, so only subscribe to those.
+    sockaddr_nl address;
+    memset(&address, 0, sizeof(address));
+    address.nl_family = AF_NETLINK;
+    address.nl_groups = RTMGRP_IPV4_IFADDR;
+    if (::bind(socket_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        qCWarning(lcHub) << "Failed to bind netlink socket: " << strerror(errno);
+        ::close(socket_);
+        socket_ = -1;
+        return;
+    }
+
+    notifier_ = new QSocketNotifier(socket_, QSocketNotifier::Read, this);
+    connect(notifier_, &QSocketNotifier::activated, this, &AddressMonitor::readMessages);
+#endif
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+AddressMonitor::~AddressMonitor() {
+#ifdef Q_OS_LINUX
+    if (socket_ >= 0) {
+        delete notifier_;
+        ::close(socket_);
+    }
+#endif
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void AddressMonitor::readMessages() {
+#ifdef Q_OS_LINUX
+    bool changed = false;
+
+    // Drain everything that is waiting, so a burst of changes (like DHCP renewing) is one notification.
+    alignas(nlmsghdr) char buffer[8192];
+    for (;;) {
+        ssize_t length = ::recv(socket_, buffer, sizeof(buffer), 0);
+        if (length < 0) {
+            if (errno == ENOBUFS) {
+                // Messages were dropped because they came in faster than they were read. It is not known what
+                // they were, so assume the worst.
+                changed = true;
+                continue;
+            }
+            if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR)) {
+                qCWarning(lcHub) << "Failed to read from netlink socket: " << strerror(errno);
+            }
+            if (errno != EINTR) {
+                break;
+            }
+            continue;
+        }
+        if (length == 0) {
+            break;
+        }
+
+        size_t size = static_cast<size_t>(length);
+        size_t offset = 0;
+        while ((offset + sizeof(nlmsghdr)) <= size) {
+            nlmsghdr header;
+            memcpy(&header, buffer + offset, sizeof(header));
+            if ((header.nlmsg_len < sizeof(nlmsghdr)) || ((offset + header.nlmsg_len) > size)) {
+                // Malformed, ignore the rest.
+                break;
+            }
+
+            if ((header.nlmsg_type == RTM_NEWADDR) || (header.nlmsg_type == RTM_DELADDR)) {
+                changed = true;
+            }
+            offset += NLMSG_ALIGN(header.nlmsg_len);
+        }
+    }
+
+    if (changed) {
+        emit addressesChanged();
+    }
+#endif
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
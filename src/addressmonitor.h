@@ -0,0 +1,32 @@
+#ifndef ADDRESSMONITOR_H_
+#define ADDRESSMONITOR_H_
+
+#include <QObject>
+#include <QSocketNotifier>
+
+// Watches for IP addresses being added to or removed from the system network interfaces. On Linux, this listens to
+// netlink route notifications, which arrive as soon as an address changes. Elsewhere, isActive() is false and callers
+// need to find out some other way.
+class AddressMonitor final : public QObject {
+    Q_OBJECT
+
+ public:
+    explicit AddressMonitor(QObject* parent = nullptr);
+    ~AddressMonitor() override;
+
+    bool isActive() const { return notifier_ != nullptr; }
+
+ signals:
+    void addressesChanged();
+
+ private slots:
+    void readMessages();
+
+ private:
+    int socket_;
+    QSocketNotifier* notifier_;
+
+    Q_DISABLE_COPY_MOVE(AddressMonitor)
+};
+
+#endif  // ADDRESSMONITOR_H_
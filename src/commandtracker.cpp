@@ -0,0 +1,200 @@
+#include "commandtracker.h"
+
+#include <QJsonArray>
+#include <QtMath>
+#include <limits>
+
+#include "logging.h"
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+namespace {
+constexpr double NUMBER_TOLERANCE = 1.0e-3;
+}  // namespace
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+CommandTracker::CommandTracker(QObject* parent)
+    : QObject(parent), maxAttempts_(4), initialBackoff_(500), maxBackoff_(4 * 1000), defaultDeadline_(15 * 1000) {
+    clock_.start();
+
+    // A single timer drives both retries and deadlines, armed for whichever is due first.
+    timer_.setSingleShot(true);
+    connect(&timer_, &QTimer::timeout, this, &CommandTracker::processCommands);
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void CommandTracker::track(const QString& key, const QJsonValue& expected, const Sender& send, const int deadline) {
+    if (key.isEmpty() || !send) {
+        qCWarning(lcHue) << "Ignoring request to track invalid command";
+        return;
+    }
+
+    // A new command for the same key supersedes any one that is still pending.
+    bool wasPending = commands_.contains(key);
+    qint64 now = clock_.elapsed();
+    commands_.insert(key, Command{expected, send, 1, now, -1, now + ((deadline > 0) ? deadline : defaultDeadline_)});
+
+    (void)failedValues_.remove(key);
+    if (failedKeys_.removeAll(key) > 0) {
+        emit failedKeysChanged();
+    }
+    if (!wasPending) {
+        emit pendingKeysChanged();
+    }
+
+    send();
+    scheduleTimer();
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void CommandTracker::confirm(const QString& key, const QJsonValue& reported) {
+    auto it = commands_.constFind(key);
+    if (it == commands_.constEnd()) {
+        // Nothing outstanding for this key, but a command given up on may have been applied late after all.
+        auto failedIt = failedValues_.constFind(key);
+        if ((failedIt != failedValues_.constEnd()) && matches(*failedIt, reported)) {
+            failedValues_.erase(failedIt);
+            (void)failedKeys_.removeAll(key);
+            emit failedKeysChanged();
+        }
+        return;
+    }
+
+    if (matches(it->expected, reported)) {
+        finish(key, false);
+        emit commandSucceeded(key);
+    } else {
+        // The device has not applied the command (yet), so try again once the backoff period has elapsed.
+        scheduleRetry(key);
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void CommandTracker::reject(const QString& key) {
+    if (commands_.contains(key)) {
+        scheduleRetry(key);
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void CommandTracker::rejectAll() {
+    const QStringList keys = commands_.keys();
+    for (const auto& key : keys) {
+        scheduleRetry(key);
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void CommandTracker::drop(const QString& key) {
+    if (commands_.contains(key)) {
+        finish(key, false);
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void CommandTracker::processCommands() {
+    qint64 now = clock_.elapsed();
+
+    const QStringList keys = commands_.keys();
+    for (const auto& key : keys) {
+        auto it = commands_.find(key);
+        if (it == commands_.end()) {
+            // Resolved as a side effect of a previous command being sent.
+            continue;
+        }
+
+        if (it->deadline <= now) {
+            qCWarning(lcHue) << "Giving up on command that was never confirmed: " << key;
+            finish(key, true);
+            emit commandTimedOut(key);
+        } else if ((it->nextAttempt >= 0) && (it->nextAttempt <= now)) {
+            it->attempts++;
+            it->lastSent = now;
+            it->nextAttempt = -1;
+            Sender send = it->send;  // Copy, since sending may cause the entry to be replaced.
+            send();
+        }
+    }
+
+    scheduleTimer();
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void CommandTracker::scheduleRetry(const QString& key) {
+    auto it = commands_.find(key);
+    if (it->nextAttempt >= 0) {
+        // Already scheduled.
+        return;
+    }
+
+    if (it->attempts >= maxAttempts_) {
+        qCWarning(lcHue) << "Giving up on command after " << it->attempts << " attempts: " << key;
+        finish(key, true);
+        emit commandFailed(key);
+        return;
+    }
+
+    // Back off exponentially from the last time the command was sent.
+    int backoff = qMin(initialBackoff_ << qMin(it->attempts - 1, 16), maxBackoff_);
+    it->nextAttempt = it->lastSent + backoff;
+    scheduleTimer();
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void CommandTracker::finish(const QString& key, const bool failed) {
+    QJsonValue expected = commands_.take(key).expected;
+    emit pendingKeysChanged();
+
+    if (failed) {
+        // Kept so that the failure can be cleared once the device is seen in the commanded state after all.
+        failedValues_.insert(key, expected);
+        if (!failedKeys_.contains(key)) {
+            failedKeys_.append(key);
+            emit failedKeysChanged();
+        }
+    }
+
+    scheduleTimer();
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void CommandTracker::scheduleTimer() {
+    if (commands_.isEmpty()) {
+        timer_.stop();
+        return;
+    }
+
+    qint64 due = std::numeric_limits<qint64>::max();
+    for (const auto& command : qAsConst(commands_)) {
+        due = qMin(due, command.deadline);
+        if (command.nextAttempt >= 0) {
+            due = qMin(due, command.nextAttempt);
+        }
+    }
+
+    timer_.start(static_cast<int>(qMax<qint64>(0, due - clock_.elapsed())));
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+bool CommandTracker::matches(const QJsonValue& expected, const QJsonValue& reported) {
+    // Devices round values they report back (e.g. XY coordinates), so allow numbers some leeway.
+    if (expected.isDouble() && reported.isDouble()) {
+        double difference = qAbs(expected.toDouble() - reported.toDouble());
+        return difference <= (NUMBER_TOLERANCE * qMax(1.0, qAbs(expected.toDouble())));
+    }
+    if (expected.isArray() && reported.isArray()) {
+        QJsonArray expectedArray = expected.toArray();
+        QJsonArray reportedArray = reported.toArray();
+        if (expectedArray.size() != reportedArray.size()) {
+            return false;
+        }
+        for (int i = 0; i < expectedArray.size(); i++) {
+            if (!matches(expectedArray.at(i), reportedArray.at(i))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    return expected == reported;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
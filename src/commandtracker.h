@@ -0,0 +1,82 @@
+#ifndef COMMANDTRACKER_H_
+#define COMMANDTRACKER_H_
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonValue>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+
+#include <functional>
+
+class CommandTracker final : public QObject {
+    Q_OBJECT
+
+    // clang-format off
+    Q_PROPERTY(QStringList pendingKeys  READ pendingKeys  NOTIFY pendingKeysChanged)
+    Q_PROPERTY(QStringList failedKeys   READ failedKeys   NOTIFY failedKeysChanged)
+    // clang-format on
+
+ public:
+    using Sender = std::function<void()>;
+
+    explicit CommandTracker(QObject* parent = nullptr);
+
+    QStringList pendingKeys() const { return commands_.keys(); }
+    const QStringList& failedKeys() const { return failedKeys_; }
+    bool isPending(const QString& key) const { return commands_.contains(key); }
+
+    void setMaxAttempts(int value) { maxAttempts_ = value; }
+    void setInitialBackoff(int value) { initialBackoff_ = value; }
+    void setMaxBackoff(int value) { maxBackoff_ = value; }
+    void setDefaultDeadline(int value) { defaultDeadline_ = value; }
+
+    void track(const QString& key, const QJsonValue& expected, const Sender& send, int deadline = -1);
+    void confirm(const QString& key, const QJsonValue& reported);
+    void reject(const QString& key);
+    void rejectAll();
+    void drop(const QString& key);  // Refused for good, so give up without retrying or counting it as failed
+
+ signals:
+    void pendingKeysChanged();
+    void failedKeysChanged();
+    void commandSucceeded(const QString& key);
+    void commandTimedOut(const QString& key);
+    void commandFailed(const QString& key);
+
+ private slots:
+    void processCommands();
+
+ private:
+    struct Command {
+        QJsonValue expected;
+        Sender send;
+        int attempts;
+        qint64 lastSent;
+        qint64 nextAttempt;  // -1 when no retry is scheduled
+        qint64 deadline;
+    };
+
+    QHash<QString, Command> commands_;
+    QStringList failedKeys_;
+    QHash<QString, QJsonValue> failedValues_;  // Key: failed key, Value: what it was last expected to become
+    int maxAttempts_;
+    int initialBackoff_;
+    int maxBackoff_;
+    int defaultDeadline_;
+
+    QElapsedTimer clock_;
+    QTimer timer_;
+
+    void scheduleRetry(const QString& key);
+    void finish(const QString& key, bool failed);
+    void scheduleTimer();
+
+    static bool matches(const QJsonValue& expected, const QJsonValue& reported);
+
+    Q_DISABLE_COPY_MOVE(CommandTracker)
+};
+
+#endif  // COMMANDTRACKER_H_
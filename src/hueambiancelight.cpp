@@ -2,6 +2,7 @@
 
 #include <QtMath>
 
+#include "logging.h"
 #include "vchub.h"
 /*--------------------------------------------------------------------------------------------------------------------*/
 
@@ -57,7 +58,7 @@ QColor HueAmbianceLight::ambientColor() const {
 
 void HueAmbianceLight::commandColorTemperature(int colorTemperature) {
     if ((colorTemperature < minColorTemperature()) || (colorTemperature > maxColorTemperature())) {
-        qDebug() << "Ignoring request to set invalid color temperature for light with ID: " << id_;
+        qCWarning(lcHue) << "Ignoring request to set invalid color temperature for light with ID: " << id_;
         return;
     }
 
@@ -68,7 +69,7 @@ void HueAmbianceLight::commandColorTemperature(int colorTemperature) {
 
     // Scale from kelvins to mirek.
     colorTemperature = qRound(1.0e6 / colorTemperature);
-    VCHub::instance()->hue()->commandDeviceState(id_, QJsonObject{{"ct", colorTemperature}});
+    commandState("ct", colorTemperature);
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
 
@@ -3,6 +3,7 @@
 #include <QJsonArray>
 #include <QtMath>
 
+#include "logging.h"
 #include "vchub.h"
 /*--------------------------------------------------------------------------------------------------------------------*/
 
@@ -13,7 +14,7 @@ HueColorLight::HueColorLight(int id, QObject* parent) : HueAmbianceLight(id, par
 
 void HueColorLight::commandColor(const QColor& color) {
     if (!color.isValid()) {
-        qDebug() << "Ignoring request to set invalid color for light with ID: " << id_;
+        qCWarning(lcHue) << "Ignoring request to set invalid color for light with ID: " << id_;
         return;
     }
 
@@ -42,7 +43,7 @@ void HueColorLight::commandColor(const QColor& color) {
 
 void HueColorLight::commandColor(const int hue) {
     if ((hue < 0) || (hue > 359)) {
-        qDebug() << "Ignoring request to set invalid hue for light with ID: " << id_;
+        qCWarning(lcHue) << "Ignoring request to set invalid hue for light with ID: " << id_;
         return;
     }
 
@@ -52,7 +53,7 @@ void HueColorLight::commandColor(const int hue) {
 
 void HueColorLight::commandColor(const double x, const double y) {
     if (qIsNaN(x) || qIsNaN(y)) {
-        qDebug() << "Ignoring request to set invalid XY for light with ID: " << id_;
+        qCWarning(lcHue) << "Ignoring request to set invalid XY for light with ID: " << id_;
         return;
     }
 
@@ -62,7 +63,7 @@ void HueColorLight::commandColor(const double x, const double y) {
     }
 
     // BDP: Updated color temperature may not be reported back for several seconds.
-    VCHub::instance()->hue()->commandDeviceState(id_, QJsonObject{{"xy", QJsonArray{x, y}}});
+    commandState("xy", QJsonArray{x, y});
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
 
@@ -2,11 +2,18 @@
 
 #include <QJsonArray>
 
+#include "logging.h"
 #include "vchub.h"
 /*--------------------------------------------------------------------------------------------------------------------*/
 
-HueDevice::HueDevice(int id, QObject* parent) : QObject(parent), id_(id), isReachable_(false), isOn_(false) {
-    qDebug() << "Created Hue device with ID: " << id_;
+namespace {
+constexpr int BRIDGE_INTERNAL_ERROR = 901;  // Hue API error type
+}  // namespace
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+HueDevice::HueDevice(int id, QObject* parent)
+    : QObject(parent), id_(id), isReachable_(false), isOn_(false), commands_(new CommandTracker(this)) {
+    qCDebug(lcHue) << "Created Hue device with ID: " << id_;
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
 
@@ -19,7 +26,7 @@ void HueDevice::setRoom(const QString& value) {
 /*--------------------------------------------------------------------------------------------------------------------*/
 
 void HueDevice::commandPower(const bool on) {
-    VCHub::instance()->hue()->commandDeviceState(id_, QJsonObject{{"on", on}});
+    commandState("on", on);
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
 
@@ -43,11 +50,24 @@ void HueDevice::handleResponse(const QJsonDocument& response) {
                         QStringList parts = argument.split('/');
                         state.insert(parts.last(), successObject.value(argument));
                     } else {
-                        qDebug() << "Got unexpected argument when handling response for Hue device: " << id_;
+                        qCWarning(lcHue) << "Got unexpected argument when handling response for Hue device: " << id_;
                     }
                 }
             } else {
-                qDebug() << "Received error when handling response for Hue device: " << id_;
+                qCWarning(lcHue) << "Received error when handling response for Hue device: " << id_;
+
+                // The error is identified by the same API endpoint. Only an internal error on the bridge is worth
+                // trying again, since the rest (e.g. a parameter that cannot change while the light is off) are final.
+                QJsonObject errorObject = responseObject.value("error").toObject();
+                QString address = errorObject.value("address").toString();
+                if (!address.isEmpty()) {
+                    QString key = address.split('/').last();
+                    if (errorObject.value("type").toInt() == BRIDGE_INTERNAL_ERROR) {
+                        commands_->reject(key);
+                    } else {
+                        commands_->drop(key);
+                    }
+                }
             }
         }
 
@@ -57,11 +77,19 @@ void HueDevice::handleResponse(const QJsonDocument& response) {
         // No, pass through.
         handleResponseData(response.object());
     } else {
-        qDebug() << "Failed to parse response for Hue device: " << id_;
+        qCWarning(lcHue) << "Failed to parse response for Hue device: " << id_;
     }
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
 
+void HueDevice::commandState(const QString& key, const QJsonValue& value) {
+    // Keep commanding the state until it is reported back, within reason.
+    commands_->track(key, value, [this, key, value] {
+        VCHub::instance()->hue()->commandDeviceState(id_, QJsonObject{{key, value}});
+    });
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
 void HueDevice::handleStateData(const QJsonObject& state) {
     if (state.contains("reachable")) {
         bool reachable = state.value("reachable").toBool();
@@ -104,7 +132,11 @@ void HueDevice::handleResponseData(const QJsonObject& response) {
         }
     }
 
-    // Unpack and process state information.
-    handleStateData(response.value("state").toObject());
+    // Unpack and process state information, confirming any commands that it reflects.
+    QJsonObject state = response.value("state").toObject();
+    for (auto it = state.constBegin(); it != state.constEnd(); ++it) {
+        commands_->confirm(it.key(), it.value());
+    }
+    handleStateData(state);
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
@@ -6,6 +6,8 @@
 #include <QObject>
 #include <QString>
 
+#include "commandtracker.h"
+
 class HueDevice : public QObject {
     Q_OBJECT
 
@@ -17,6 +19,7 @@ class HueDevice : public QObject {
     Q_PROPERTY(bool isReachable     READ isReachable                 NOTIFY isReachableChanged)
     Q_PROPERTY(bool isOn            READ isOn                        NOTIFY isOnChanged)
     Q_PROPERTY(QString room         READ room         WRITE setRoom  NOTIFY roomChanged)
+    Q_PROPERTY(CommandTracker * commands  READ commands              CONSTANT)
     // clang-format on
 
  public:
@@ -30,6 +33,7 @@ class HueDevice : public QObject {
     bool isOn() const { return isOn_; }
     const QString& room() const { return room_; }
     void setRoom(const QString& value);
+    CommandTracker* commands() const { return commands_; }
 
     Q_INVOKABLE void commandPower(bool on);
 
@@ -53,7 +57,9 @@ class HueDevice : public QObject {
     bool isReachable_;
     bool isOn_;
     QString room_;
+    CommandTracker* commands_;
 
+    void commandState(const QString& key, const QJsonValue& value);
     virtual void handleStateData(const QJsonObject& state);
 
  private:
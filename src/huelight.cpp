@@ -1,5 +1,6 @@
 #include "huelight.h"
 
+#include "logging.h"
 #include "vchub.h"
 /*--------------------------------------------------------------------------------------------------------------------*/
 
@@ -16,7 +17,7 @@ HueLight::HueLight(int id, QObject* parent) : HueDevice(id, parent) {
 
 void HueLight::commandBrightness(const double brightness) {
     if (qIsNaN(brightness) || (brightness < 0.0) || (brightness > 100.0)) {
-        qDebug() << "Ignoring request to set invalid brightness for light with ID: " << id_;
+        qCWarning(lcHue) << "Ignoring request to set invalid brightness for light with ID: " << id_;
         return;
     }
 
@@ -28,7 +29,7 @@ void HueLight::commandBrightness(const double brightness) {
     // Scale from a percentage into the capable range of the light.
     int scaledBrightness =
         qRound(((brightness / 100.0) * (MAX_CAPABLE_BRIGHTNESS - MIN_CAPABLE_BRIGHTNESS)) + MIN_CAPABLE_BRIGHTNESS);
-    VCHub::instance()->hue()->commandDeviceState(id_, QJsonObject{{"bri", scaledBrightness}});
+    commandState("bri", scaledBrightness);
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
 
@@ -0,0 +1,266 @@
+#include "logging.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+Q_LOGGING_CATEGORY(lcConfig, "vc.config")
+Q_LOGGING_CATEGORY(lcDriver, "vc.driver")
+Q_LOGGING_CATEGORY(lcFacts, "vc.facts")
+Q_LOGGING_CATEGORY(lcHub, "vc.hub")
+Q_LOGGING_CATEGORY(lcHue, "vc.hue")
+Q_LOGGING_CATEGORY(lcMemory, "vc.memory")
+Q_LOGGING_CATEGORY(lcMetrics, "vc.metrics")
+Q_LOGGING_CATEGORY(lcNanoleaf, "vc.nanoleaf")
+Q_LOGGING_CATEGORY(lcNetwork, "vc.network")
+Q_LOGGING_CATEGORY(lcPiHole, "vc.pihole")
+Q_LOGGING_CATEGORY(lcPlugin, "vc.plugin")
+Q_LOGGING_CATEGORY(lcProfiler, "vc.profiler")
+Q_LOGGING_CATEGORY(lcSpotify, "vc.spotify")
+Q_LOGGING_CATEGORY(lcStartup, "vc.startup")
+Q_LOGGING_CATEGORY(lcWeather, "vc.weather")
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+namespace {
+Logger* instance_ = nullptr;
+constexpr qint64 RATE_LIMIT_WINDOW = 60 * 1000;  // Milliseconds
+constexpr int RATE_LIMIT_BURST = 3;              // Repeats written per window
+}  // namespace
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+Logger::Logger()
+    : enqueuePosition_(0), dequeuePosition_(0), droppedCount_(0), isRunning_(1), writer_(nullptr), lastSweep_(0) {
+    for (int i = 0; i < CAPACITY; i++) {
+        slots_[i].sequence.storeRelaxed(static_cast<quintptr>(i));
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void Logger::install() {
+    if (!instance_) {
+        instance_ = new Logger();
+        instance_->writer_ = QThread::create([] { instance_->write(); });
+        instance_->writer_->setObjectName("LogWriter");
+        instance_->writer_->start(QThread::LowPriority);
+        (void)qInstallMessageHandler(&Logger::handleMessage);
+
+        // Drain whatever is left once the application goes away, on any path out of main(). Post routines cover
+        // returning from main(), and exit handlers cover calling exit() directly, like QCommandLineParser does.
+        qAddPostRoutine(&Logger::shutdown);
+        (void)std::atexit(&Logger::shutdown);
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void Logger::shutdown() {
+    if (instance_ && instance_->writer_) {
+        (void)qInstallMessageHandler(nullptr);
+        instance_->isRunning_.storeRelease(0);
+        instance_->available_.release();
+        instance_->writer_->wait();
+        delete instance_->writer_;
+        instance_->writer_ = nullptr;
+
+        // The logger itself is left in place, another thread may still be part way through handing it a message.
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void Logger::handleMessage(const QtMsgType type, const QMessageLogContext& context, const QString& message) {
+    qint64 time = QDateTime::currentMSecsSinceEpoch();
+    const char* category = context.category ? context.category : "default";
+
+    if (type == QtFatalMsg) {
+        // Nothing gets written after this, so have the writer finish everything queued before it and then write
+        // directly.
+        if (QThread::currentThread() != instance_->writer_) {
+            shutdown();
+        }
+        writeLine(time, type, category, message);
+        (void)std::fflush(stderr);
+        return;
+    }
+
+    // Category names are string literals, so holding on to the pointer is safe.
+    if (!instance_->push(Entry{time, type, category, message})) {
+        instance_->droppedCount_.ref();
+    }
+    instance_->available_.release();
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+bool Logger::push(Entry&& entry) {
+    // Claim a slot, which is free once the writer has moved its sequence a lap ahead of the position.
+    quintptr position = enqueuePosition_.loadRelaxed();
+    Slot* slot = nullptr;
+    for (;;) {
+        slot = &slots_[position & (CAPACITY - 1)];
+        quintptr sequence = slot->sequence.loadAcquire();
+        if (sequence == position) {
+            if (enqueuePosition_.testAndSetRelaxed(position, position + 1, position)) {
+                break;
+            }
+        } else if (static_cast<qintptr>(sequence - position) < 0) {
+            // Full, the writer has fallen behind.
+            return false;
+        } else {
+            // Another thread got the slot first.
+            position = enqueuePosition_.loadRelaxed();
+        }
+    }
+
+    slot->entry = std::move(entry);
+    slot->sequence.storeRelease(position + 1);
+    return true;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+bool Logger::pop(Entry& entry) {
+    Slot& slot = slots_[dequeuePosition_ & (CAPACITY - 1)];
+    if (slot.sequence.loadAcquire() != (dequeuePosition_ + 1)) {
+        // Empty, or the next slot is still being filled.
+        return false;
+    }
+
+    entry = std::move(slot.entry);
+    slot.entry.message.clear();
+    slot.sequence.storeRelease(dequeuePosition_ + CAPACITY);
+    dequeuePosition_++;
+    return true;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void Logger::write() {
+    Entry entry{0, QtDebugMsg, nullptr, QString()};
+    for (;;) {
+        // Take the wakeups first, so that anything queued or any stop from here on leaves one behind for the next wait.
+        // Then check before draining, so that everything queued before shutting down still gets written.
+        (void)available_.tryAcquire(available_.available());
+        bool isRunning = isRunning_.loadAcquire();
+        while (pop(entry)) {
+            if (shouldWrite(entry)) {
+                writeLine(entry.time, entry.type, entry.category, entry.message);
+            }
+        }
+
+        qint64 now = QDateTime::currentMSecsSinceEpoch();
+        int droppedCount = droppedCount_.fetchAndStoreRelaxed(0);
+        if (droppedCount > 0) {
+            writeLine(now,
+                      QtWarningMsg,
+                      "vc.logging",
+                      QString("Dropped %1 messages because the log buffer was full").arg(droppedCount));
+        }
+        sweepRepeats(now, !isRunning);
+        (void)std::fflush(stderr);
+
+        if (!isRunning) {
+            return;
+        }
+
+        // Sleep until there is something to write, waking on time for the next sweep only while repeats are held back.
+        bool isHoldingBack = std::any_of(
+            repeats_.cbegin(), repeats_.cend(), [](const Repeat& repeat) { return repeat.suppressedCount > 0; });
+        if (isHoldingBack) {
+            qint64 timeout = qMax<qint64>(0, (lastSweep_ + RATE_LIMIT_WINDOW) - QDateTime::currentMSecsSinceEpoch());
+            (void)available_.tryAcquire(1, static_cast<int>(timeout));
+        } else {
+            available_.acquire();
+        }
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+bool Logger::shouldWrite(const Entry& entry) {
+    QString key = QLatin1String(entry.category) + QLatin1Char('\n') + entry.message;
+    auto it = repeats_.find(key);
+    if (it == repeats_.end()) {
+        repeats_.insert(key, Repeat{entry.time, 1, 0});
+        return true;
+    }
+
+    if ((entry.time - it->windowStart) >= RATE_LIMIT_WINDOW) {
+        // Start a new window, noting how many were left out of the last one.
+        if (it->suppressedCount > 0) {
+            writeLine(entry.time,
+                      entry.type,
+                      entry.category,
+                      QString("Suppressed %1 repeats of: %2").arg(it->suppressedCount).arg(entry.message));
+        }
+        *it = Repeat{entry.time, 1, 0};
+        return true;
+    }
+
+    if (++it->count <= RATE_LIMIT_BURST) {
+        return true;
+    }
+    it->suppressedCount++;
+    return false;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void Logger::sweepRepeats(const qint64 now, const bool force) {
+    if (!force && ((now - lastSweep_) < RATE_LIMIT_WINDOW)) {
+        return;
+    }
+    lastSweep_ = now;
+
+    // Forget about messages that have stopped repeating, reporting any that were held back.
+    for (auto it = repeats_.begin(); it != repeats_.end();) {
+        if (force || ((now - it->windowStart) >= RATE_LIMIT_WINDOW)) {
+            if (it->suppressedCount > 0) {
+                int separator = it.key().indexOf('\n');
+                QString message = it.key().mid(separator + 1);
+                writeLine(now,
+                          QtInfoMsg,
+                          qPrintable(it.key().left(separator)),
+                          QString("Suppressed %1 repeats of: %2").arg(it->suppressedCount).arg(message));
+            }
+            it = repeats_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void Logger::writeLine(const qint64 time, const QtMsgType type, const char* category, const QString& message) {
+    char level = 'D';
+    switch (type) {
+        case QtDebugMsg:
+            level = 'D';
+            break;
+
+        case QtInfoMsg:
+            level = 'I';
+            break;
+
+        case QtWarningMsg:
+            level = 'W';
+            break;
+
+        case QtCriticalMsg:
+            level = 'C';
+            break;
+
+        case QtFatalMsg:
+            level = 'F';
+            break;
+    }
+
+    // One line per message: time, level, category, and then the message itself.
+    QByteArray line = QDateTime::fromMSecsSinceEpoch(time).toString(Qt::ISODateWithMs).toLatin1();
+    line += ' ';
+    line += level;
+    line += ' ';
+    line += category;
+    line += ": ";
+    line += message.toLocal8Bit();
+    line += '\n';
+    (void)std::fwrite(line.constData(), 1, static_cast<size_t>(line.size()), stderr);
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
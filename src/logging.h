@@ -0,0 +1,80 @@
+#ifndef LOGGING_H_
+#define LOGGING_H_
+
+#include <QAtomicInteger>
+#include <QHash>
+#include <QLoggingCategory>
+#include <QSemaphore>
+#include <QString>
+#include <QThread>
+
+Q_DECLARE_LOGGING_CATEGORY(lcConfig)
+Q_DECLARE_LOGGING_CATEGORY(lcDriver)
+Q_DECLARE_LOGGING_CATEGORY(lcFacts)
+Q_DECLARE_LOGGING_CATEGORY(lcHub)
+Q_DECLARE_LOGGING_CATEGORY(lcHue)
+Q_DECLARE_LOGGING_CATEGORY(lcMemory)
+Q_DECLARE_LOGGING_CATEGORY(lcMetrics)
+Q_DECLARE_LOGGING_CATEGORY(lcNanoleaf)
+Q_DECLARE_LOGGING_CATEGORY(lcNetwork)
+Q_DECLARE_LOGGING_CATEGORY(lcPiHole)
+Q_DECLARE_LOGGING_CATEGORY(lcPlugin)
+Q_DECLARE_LOGGING_CATEGORY(lcProfiler)
+Q_DECLARE_LOGGING_CATEGORY(lcSpotify)
+Q_DECLARE_LOGGING_CATEGORY(lcStartup)
+Q_DECLARE_LOGGING_CATEGORY(lcWeather)
+
+// Takes over Qt message output so that logging never blocks the thread doing it. Messages are put on a lock-free ring
+// buffer and written out as structured lines by a background thread, which sleeps until there is something to write
+// and also rate limits messages that keep repeating. Debug messages are compiled out of release builds, and otherwise
+// only cost a flag check per category until they are enabled with QT_LOGGING_RULES.
+class Logger final {
+ public:
+    static void install();
+    static void shutdown();
+
+ private:
+    static constexpr int CAPACITY = 1024;  // Must be a power of two
+
+    struct Entry {
+        qint64 time;  // Milliseconds since the epoch
+        QtMsgType type;
+        const char* category;
+        QString message;
+    };
+
+    struct Slot {
+        QAtomicInteger<quintptr> sequence;
+        Entry entry;
+    };
+
+    struct Repeat {
+        qint64 windowStart;  // Milliseconds since the epoch
+        int count;
+        int suppressedCount;
+    };
+
+    Logger();
+
+    Slot slots_[CAPACITY];
+    QAtomicInteger<quintptr> enqueuePosition_;
+    quintptr dequeuePosition_;  // Only touched by the writer
+    QAtomicInt droppedCount_;
+    QAtomicInt isRunning_;
+    QSemaphore available_;  // Released for every message, and to stop the writer
+    QThread* writer_;
+    QHash<QString, Repeat> repeats_;  // Key: category and message, only touched by the writer
+    qint64 lastSweep_;
+
+    static void handleMessage(QtMsgType type, const QMessageLogContext& context, const QString& message);
+    bool push(Entry&& entry);
+    bool pop(Entry& entry);
+    void write();
+    bool shouldWrite(const Entry& entry);
+    void sweepRepeats(qint64 now, bool force);
+    static void writeLine(qint64 time, QtMsgType type, const char* category, const QString& message);
+
+    Q_DISABLE_COPY_MOVE(Logger)
+};
+
+#endif  // LOGGING_H_
@@ -2,15 +2,40 @@
 #include <QCommandLineParser>
 #include <QFontDatabase>
 #include <QQmlApplicationEngine>
+#include <QQuickWindow>
 
+#include "logging.h"
+#include "networkinterface.h"
+#include "pluginviewer.h"
+#include "scriptdriver.h"
+#include "startupprofiler.h"
 #include "vchub.h"
 /*--------------------------------------------------------------------------------------------------------------------*/
 
 int main(int argc, char* argv[]) {
-    // Bring in the Virtual Keyboard.
-    qputenv("QT_IM_MODULE", QByteArray("qtvirtualkeyboard"));
-    qputenv("QT_VIRTUALKEYBOARD_LAYOUT_PATH", QByteArray("qrc:/keyboard/layouts"));
-    qputenv("QT_VIRTUALKEYBOARD_STYLE", QByteArray("vc"));
+    // Time each phase of starting up, for reporting on when asked to.
+    StartupProfiler* startup = StartupProfiler::instance();
+
+    // Write log messages from the background from here on.
+    Logger::install();
+    startup->mark("Logger installed");
+
+    // Running without a display has to be settled before the application exists, ahead of parsing the command line.
+    bool isHeadless = false;
+    for (int i = 1; i < argc; i++) {
+        if (qstrcmp(argv[i], "--headless") == 0) {
+            isHeadless = true;
+        }
+    }
+
+    if (isHeadless) {
+        qputenv("QT_QPA_PLATFORM", QByteArray("offscreen"));
+    } else {
+        // Bring in the Virtual Keyboard.
+        qputenv("QT_IM_MODULE", QByteArray("qtvirtualkeyboard"));
+        qputenv("QT_VIRTUALKEYBOARD_LAYOUT_PATH", QByteArray("qrc:/keyboard/layouts"));
+        qputenv("QT_VIRTUALKEYBOARD_STYLE", QByteArray("vc"));
+    }
 
     // Apply high-level application properties.
     QCoreApplication::setApplicationName("Vice City Dashboard");
@@ -22,6 +47,8 @@ int main(int argc, char* argv[]) {
     // Create the application context.
     QApplication app(argc, argv);
     app.setObjectName("app");
+    startup->setParent(&app);
+    startup->mark("Application created");
 
     // Register command line options.
     QCommandLineParser parser;
@@ -29,6 +56,21 @@ int main(int argc, char* argv[]) {
     parser.addHelpOption();
     parser.addVersionOption();
     parser.addOption({{"c", "config"}, "Load configuration from <file>.", "file"});
+    parser.addOption({"record", "Record network traffic to <file>.", "file"});
+    parser.addOption({"replay", "Answer network requests from a recording in <file> instead.", "file"});
+    parser.addOption({"replay-speed",
+                      "Replay at <factor> times the recorded speed, or as fast as possible with 0 (default: 1).",
+                      "factor",
+                      "1"});
+    parser.addOption({"profile-startup", "Time each phase of starting up and write a report to <file>.", "file"});
+    parser.addOption({"startup-budget",
+                      "Exit once the startup report is written, failing if interactive took over <ms> milliseconds.",
+                      "ms"});
+    parser.addOption({"headless", "Run the hub and plugins without any user interface."});
+    parser.addOption({"drive", "When headless, perform the actions in the script <file> over and over.", "file"});
+    parser.addOption({"drive-interval",
+                      "Perform a scripted action every <ms> milliseconds, instead of as the script says.",
+                      "ms"});
 
     // Process the command line options.
     parser.process(app);
@@ -39,20 +81,116 @@ int main(int argc, char* argv[]) {
         parser.showHelp(1);
     }
 
+    // Scripts stand in for someone using the dashboard, which only makes sense without anyone able to.
+    if (parser.isSet("drive") && !isHeadless) {
+        qWarning() << "Driving from a script needs --headless\n";
+        parser.showHelp(1);
+    }
+
+    // A budget is measured against the first frame, which never comes without a user interface.
+    if (parser.isSet("startup-budget") && isHeadless) {
+        qWarning() << "A startup budget cannot be used with --headless\n";
+        parser.showHelp(1);
+    }
+
+    // Set up recording or replaying of network traffic before any plugins start using the network.
+    if (parser.isSet("replay")) {
+        bool ok = false;
+        double speed = parser.value("replay-speed").toDouble(&ok);
+        if (!ok || (speed < 0.0)) {
+            qWarning() << "Invalid replay speed: " << parser.value("replay-speed");
+            return 4;
+        }
+        if (!NetworkInterface::instance()->startReplay(parser.value("replay"), speed)) {
+            return 4;
+        }
+    } else if (parser.isSet("record")) {
+        if (!NetworkInterface::instance()->startCapture(parser.value("record"))) {
+            return 4;
+        }
+    }
+
+    startup->mark("Network set up");
+
+    // Create the plugins, which start discovering their devices right away, well before the QML needs them.
+    VCHub* hub = VCHub::instance();
+    startup->mark("Hub constructed");
+
+    // Start reporting on startup now that the plugins to wait on are known.
+    if (parser.isSet("profile-startup")) {
+        int budget = 0;
+        if (parser.isSet("startup-budget")) {
+            bool ok = false;
+            budget = parser.value("startup-budget").toInt(&ok);
+            if (!ok || (budget <= 0)) {
+                qWarning() << "Invalid startup budget: " << parser.value("startup-budget");
+                return 5;
+            }
+
+            // Leave once the report is out, so that a nightly script can catch slow starts.
+            QObject::connect(startup, &StartupProfiler::finished, &app, [&app, startup] {
+                app.exit(startup->isWithinBudget() ? 0 : 6);
+            });
+        }
+
+        QStringList plugins;
+        for (VCPlugin* plugin : hub->plugins()) {
+            plugins.append(plugin->pluginName());
+        }
+        startup->start(parser.value("profile-startup"), budget, plugins);
+    } else if (parser.isSet("startup-budget")) {
+        qWarning() << "A startup budget needs --profile-startup\n";
+        parser.showHelp(1);
+    }
+
     // Load the specified config file.
-    if (!VCHub::instance()->loadConfig(parser.value("config"))) {
+    if (!hub->loadConfig(parser.value("config"))) {
         return 2;
     }
+    startup->mark("Config loaded");
+
+    // Send out the first requests now, so the replies come in while the QML is loading rather than after.
+    for (VCPlugin* plugin : hub->plugins()) {
+        plugin->refreshIfStale();
+    }
+
+    hub->setParent(&app);
+
+    // Run just the hub and its plugins when headless, optionally driven by a script.
+    if (isHeadless) {
+        if (parser.isSet("drive")) {
+            int interval = 0;
+            if (parser.isSet("drive-interval")) {
+                bool ok = false;
+                interval = parser.value("drive-interval").toInt(&ok);
+                if (!ok || (interval <= 0)) {
+                    qWarning() << "Invalid drive interval: " << parser.value("drive-interval");
+                    return 5;
+                }
+            }
+
+            ScriptDriver* driver = new ScriptDriver(&app);
+            if (!driver->load(parser.value("drive"))) {
+                return 5;
+            }
+            QObject::connect(driver, &ScriptDriver::finished, &app, &QCoreApplication::quit);
+            driver->start(interval);
+        }
+
+        return app.exec();
+    }
 
     // Register the fonts for the application.
     QFontDatabase::addApplicationFont(":/fonts/Lato-Bold.ttf");
     QFontDatabase::addApplicationFont(":/fonts/Lato-Regular.ttf");
     QGuiApplication::setFont(QFont("Lato"));
+    startup->mark("Fonts registered");
 
-    // Register the central C++ type that should be exposed to QML.
+    // Register the C++ types that should be exposed to QML.
     qmlRegisterSingletonType<VCHub>("com.benprisby.vc.vchub", 1, 0, "VCHub", vchub_singletontype_provider);
-    QQmlEngine::setObjectOwnership(VCHub::instance(), QQmlEngine::CppOwnership);
-    VCHub::instance()->setParent(&app);
+    QQmlEngine::setObjectOwnership(hub, QQmlEngine::CppOwnership);
+    qmlRegisterAnonymousType<VCPlugin>("com.benprisby.vc.vchub", 1);
+    qmlRegisterType<PluginViewer>("com.benprisby.vc.vchub", 1, 0, "PluginViewer");
 
     // Create the QML context.
     QQmlApplicationEngine engine(&app);
@@ -62,6 +200,12 @@ int main(int argc, char* argv[]) {
     if (engine.rootObjects().isEmpty()) {
         return 3;
     }
+    startup->mark("QML loaded");
+
+    // Time the frames of the main window whenever profiling is turned on, and watch for the first one when starting.
+    QQuickWindow* window = qobject_cast<QQuickWindow*>(engine.rootObjects().first());
+    Profiler::instance()->attach(window);
+    startup->watch(window);
 
     return app.exec();
 }
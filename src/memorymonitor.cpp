@@ -0,0 +1,279 @@
+#include "memorymonitor.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QGuiApplication>
+#include <QWindow>
+
+#include <algorithm>
+
+#ifdef Q_OS_LINUX
+#include <malloc.h>
+#include <unistd.h>
+#endif
+
+#include "logging.h"
+#include "metrics.h"
+#include "networkinterface.h"
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+namespace {
+MemoryMonitor* instance_ = nullptr;
+constexpr double MIB = 1024.0 * 1024.0;
+constexpr int MINUTE = 60 * 1000;
+constexpr int GROWING_CLASS_LIMIT = 5;  // Classes listed in each trend line
+
+QString signedDelta(const double value, const int precision = 0) {
+    return QString("%1%2").arg((value < 0.0) ? "" : "+").arg(value, 0, 'f', precision);
+}
+}  // namespace
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+MemoryMonitor::MemoryMonitor(QObject* parent)
+    : QObject(parent),
+      isEnabled_(false),
+      growthWindow_(60),
+      growthThreshold_(32),
+      isAlerting_(false),
+      latest_{0, 0, 0, 0, 0, {}, {}} {
+    setObjectName("MemoryMonitor");
+    clock_.start();
+
+    sampleTimer_.setInterval(MINUTE);
+    sampleTimer_.setSingleShot(false);
+    connect(&sampleTimer_, &QTimer::timeout, this, &MemoryMonitor::sample);
+
+    // Publish the latest sample when metrics are scraped.
+    Metrics::instance()->addCollector([this] {
+        if (!isEnabled_) {
+            return;
+        }
+
+        Metrics* metrics = Metrics::instance();
+        metrics->gauge("vc_memory_resident_bytes", "Resident set size at the last memory sample.")
+            ->set(static_cast<double>(latest_.residentBytes));
+        metrics->gauge("vc_memory_heap_bytes", "Heap in use at the last memory sample.")
+            ->set(static_cast<double>(latest_.heapBytes));
+        metrics->gauge("vc_memory_qobjects", "Live QObjects at the last memory sample.")->set(latest_.objectCount);
+        metrics->gauge("vc_memory_alert", "Whether memory has grown past the threshold over the window.")
+            ->set(isAlerting_ ? 1.0 : 0.0);
+        for (int i = 0; i < latest_.sizes.size(); i++) {
+            metrics
+                ->gauge("vc_memory_watched_size",
+                        "Sizes of caches and tables at the last memory sample.",
+                        {{"name", watchedSizes_.at(i).first}})
+                ->set(latest_.sizes.at(i));
+        }
+    });
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+MemoryMonitor* MemoryMonitor::instance() {
+    if (!instance_) {
+        instance_ = new MemoryMonitor();
+    }
+
+    return instance_;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void MemoryMonitor::setEnabled(const bool value) {
+    if (isEnabled_ != value) {
+        isEnabled_ = value;
+        if (isEnabled_) {
+            qCInfo(lcMemory) << "Sampling memory every " << sampleTimer_.interval() << " ms";
+            sampleTimer_.start();
+            sample();
+        } else {
+            sampleTimer_.stop();
+            samples_.clear();
+            if (isAlerting_) {
+                isAlerting_ = false;
+                emit isAlertingChanged();
+            }
+        }
+        emit enabledChanged();
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void MemoryMonitor::setSampleInterval(const int value) {
+    if ((sampleTimer_.interval() != value) && (value > 0)) {
+        sampleTimer_.setInterval(value);
+        emit sampleIntervalChanged();
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void MemoryMonitor::setGrowthWindow(const int value) {
+    if ((growthWindow_ != value) && (value > 0)) {
+        growthWindow_ = value;
+        emit growthWindowChanged();
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void MemoryMonitor::setGrowthThreshold(const int value) {
+    if ((growthThreshold_ != value) && (value > 0)) {
+        growthThreshold_ = value;
+        emit growthThresholdChanged();
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+double MemoryMonitor::residentSize() const {
+    return static_cast<double>(latest_.residentBytes) / MIB;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+double MemoryMonitor::heapInUse() const {
+    return static_cast<double>(latest_.heapBytes) / MIB;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+double MemoryMonitor::growth() const {
+    if (samples_.isEmpty()) {
+        return 0.0;
+    }
+
+    return static_cast<double>(latest_.residentBytes - samples_.front().residentBytes) / MIB;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void MemoryMonitor::watchSize(const QString& name, const std::function<int()>& size) {
+    watchedSizes_.append({name, size});
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void MemoryMonitor::sample() {
+    Sample current{clock_.elapsed(),
+                   readResidentBytes(),
+                   readHeapBytes(),
+                   0,
+                   NetworkInterface::instance()->outstandingReplyCount(),
+                   {},
+                   {}};
+
+    // Count everything reachable from the application, along with any windows living outside of it, like from QML.
+    countObjects(QCoreApplication::instance(), current.classCounts, current.objectCount);
+    for (const QWindow* window : QGuiApplication::topLevelWindows()) {
+        if (!window->QObject::parent()) {
+            countObjects(window, current.classCounts, current.objectCount);
+        }
+    }
+
+    current.sizes.reserve(watchedSizes_.size());
+    for (const auto& watchedSize : qAsConst(watchedSizes_)) {
+        current.sizes.append(watchedSize.second());
+    }
+
+    // Keep just enough history to compare against the start of the window.
+    qint64 window = static_cast<qint64>(growthWindow_) * MINUTE;
+    samples_.enqueue(current);
+    while ((samples_.size() > 1) && ((current.time - samples_.at(1).time) >= window)) {
+        (void)samples_.dequeue();
+    }
+    latest_ = current;
+
+    const Sample& baseline = samples_.front();
+    logTrend(baseline);
+    emit sampled();
+
+    // Only judge growth over a full window, since memory climbs for a while after starting anyway.
+    bool isAlerting = ((current.time - baseline.time) >= window) && (growth() >= growthThreshold_);
+    if (isAlerting_ != isAlerting) {
+        isAlerting_ = isAlerting;
+        if (isAlerting_) {
+            qCWarning(lcMemory) << "Resident set grew by " << growth() << " MiB over the last " << growthWindow_
+                                << " minutes, past the threshold of " << growthThreshold_ << " MiB";
+        } else {
+            qCInfo(lcMemory) << "Resident set growth is back under the threshold";
+        }
+        emit isAlertingChanged();
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+qint64 MemoryMonitor::readResidentBytes() {
+#ifdef Q_OS_LINUX
+    // The second field is the resident set, in pages.
+    QFile statm("/proc/self/statm");
+    if (statm.open(QIODevice::ReadOnly)) {
+        QList<QByteArray> fields = statm.readAll().split(' ');
+        if (fields.size() > 1) {
+            return fields.at(1).toLongLong() * static_cast<qint64>(sysconf(_SC_PAGESIZE));
+        }
+    }
+#endif
+    return 0;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+qint64 MemoryMonitor::readHeapBytes() {
+    // Allocated ordinary blocks plus blocks mapped on their own, which is what has been handed out and not freed.
+#if defined(__GLIBC__) && ((__GLIBC__ > 2) || ((__GLIBC__ == 2) && (__GLIBC_MINOR__ >= 33)))
+    struct mallinfo2 info = mallinfo2();
+    return static_cast<qint64>(info.uordblks + info.hblkhd);
+#elif defined(__GLIBC__)
+    // Older glibc only has the version with int fields, which wrap past 2 GiB. Good enough on a Pi.
+    struct mallinfo info = mallinfo();
+    return static_cast<qint64>(static_cast<unsigned int>(info.uordblks)) + static_cast<unsigned int>(info.hblkhd);
+#else
+    return 0;
+#endif
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void MemoryMonitor::countObjects(const QObject* object, QHash<const char*, int>& classCounts, int& total) {
+    classCounts[object->metaObject()->className()]++;
+    total++;
+    for (const QObject* child : object->children()) {
+        countObjects(child, classCounts, total);
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void MemoryMonitor::logTrend(const Sample& baseline) const {
+    int minutes = static_cast<int>((latest_.time - baseline.time) / MINUTE);
+    qCInfo(lcMemory) << qPrintable(QString("Resident %1 MiB (%2 over %3 min), heap %4 MiB (%5), %6 objects (%7), "
+                                           "%8 requests outstanding")
+                                       .arg(residentSize(), 0, 'f', 1)
+                                       .arg(signedDelta(growth(), 1))
+                                       .arg(minutes)
+                                       .arg(heapInUse(), 0, 'f', 1)
+                                       .arg(signedDelta((latest_.heapBytes - baseline.heapBytes) / MIB, 1))
+                                       .arg(latest_.objectCount)
+                                       .arg(signedDelta(latest_.objectCount - baseline.objectCount))
+                                       .arg(latest_.outstandingReplyCount));
+
+    // Name the classes with the most new objects, which is where to start looking for a leak.
+    QVector<QPair<int, const char*>> growingClasses;
+    for (auto it = latest_.classCounts.constBegin(); it != latest_.classCounts.constEnd(); ++it) {
+        int delta = it.value() - baseline.classCounts.value(it.key());
+        if (delta > 0) {
+            growingClasses.append({delta, it.key()});
+        }
+    }
+    if (!growingClasses.isEmpty()) {
+        std::sort(growingClasses.begin(),
+                  growingClasses.end(),
+                  [](const QPair<int, const char*>& a, const QPair<int, const char*>& b) { return a.first > b.first; });
+
+        QStringList classes;
+        for (int i = 0; (i < growingClasses.size()) && (i < GROWING_CLASS_LIMIT); i++) {
+            classes.append(QString("%1 +%2").arg(growingClasses.at(i).second).arg(growingClasses.at(i).first));
+        }
+        qCInfo(lcMemory) << qPrintable("Growing classes: " + classes.join(", "));
+    }
+
+    if (!watchedSizes_.isEmpty()) {
+        QStringList sizes;
+        for (int i = 0; i < watchedSizes_.size(); i++) {
+            int size = latest_.sizes.at(i);
+            int delta = size - baseline.sizes.value(i);
+            sizes.append(QString("%1 %2 (%3)").arg(watchedSizes_.at(i).first).arg(size).arg(signedDelta(delta)));
+        }
+        qCInfo(lcMemory) << qPrintable("Sizes: " + sizes.join(", "));
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,98 @@
+#ifndef MEMORYMONITOR_H_
+#define MEMORYMONITOR_H_
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QPair>
+#include <QQueue>
+#include <QString>
+#include <QTimer>
+#include <QVector>
+
+#include <functional>
+
+// Keeps an eye on memory use while running for weeks at a time. Each sample takes the resident set size, the heap in
+// use, live QObjects by class, outstanding requests, and the sizes of whatever has been watched, and logs how they have
+// trended over the growth window. The alert is raised while the resident set has grown by more than the threshold over
+// that window.
+class MemoryMonitor final : public QObject {
+    Q_OBJECT
+
+    // clang-format off
+    Q_PROPERTY(bool enabled                READ isEnabled              WRITE setEnabled          NOTIFY enabledChanged)
+    Q_PROPERTY(int sampleInterval          READ sampleInterval         WRITE setSampleInterval   NOTIFY sampleIntervalChanged)
+    Q_PROPERTY(int growthWindow            READ growthWindow           WRITE setGrowthWindow     NOTIFY growthWindowChanged)
+    Q_PROPERTY(int growthThreshold         READ growthThreshold        WRITE setGrowthThreshold  NOTIFY growthThresholdChanged)
+    Q_PROPERTY(double residentSize         READ residentSize                                     NOTIFY sampled)
+    Q_PROPERTY(double heapInUse            READ heapInUse                                        NOTIFY sampled)
+    Q_PROPERTY(double growth               READ growth                                           NOTIFY sampled)
+    Q_PROPERTY(int objectCount             READ objectCount                                      NOTIFY sampled)
+    Q_PROPERTY(int outstandingReplyCount   READ outstandingReplyCount                            NOTIFY sampled)
+    Q_PROPERTY(bool isAlerting             READ isAlerting                                       NOTIFY isAlertingChanged)
+    // clang-format on
+
+ public:
+    static MemoryMonitor* instance();
+
+    bool isEnabled() const { return isEnabled_; }
+    void setEnabled(bool value);
+    int sampleInterval() const { return sampleTimer_.interval(); }  // Milliseconds
+    void setSampleInterval(int value);
+    int growthWindow() const { return growthWindow_; }  // Minutes
+    void setGrowthWindow(int value);
+    int growthThreshold() const { return growthThreshold_; }  // MiB
+    void setGrowthThreshold(int value);
+    double residentSize() const;  // MiB
+    double heapInUse() const;     // MiB
+    double growth() const;        // MiB of resident set over the growth window
+    int objectCount() const { return latest_.objectCount; }
+    int outstandingReplyCount() const { return latest_.outstandingReplyCount; }
+    bool isAlerting() const { return isAlerting_; }
+
+    // Adds something that could grow without bound to what is sampled, like a cache or a table of devices.
+    void watchSize(const QString& name, const std::function<int()>& size);
+
+ signals:
+    void enabledChanged();
+    void sampleIntervalChanged();
+    void growthWindowChanged();
+    void growthThresholdChanged();
+    void sampled();
+    void isAlertingChanged();
+
+ private slots:
+    void sample();
+
+ private:
+    struct Sample {
+        qint64 time;           // Milliseconds on the clock
+        qint64 residentBytes;  // 0 when not available
+        qint64 heapBytes;      // 0 when not available
+        int objectCount;
+        int outstandingReplyCount;
+        QHash<const char*, int> classCounts;  // Key: class name, which is static
+        QVector<int> sizes;                   // In the order watched
+    };
+
+    explicit MemoryMonitor(QObject* parent = nullptr);
+
+    bool isEnabled_;
+    int growthWindow_;
+    int growthThreshold_;
+    bool isAlerting_;
+    QTimer sampleTimer_;
+    QElapsedTimer clock_;
+    QVector<QPair<QString, std::function<int()>>> watchedSizes_;
+    QQueue<Sample> samples_;  // Oldest first, going back just past the growth window
+    Sample latest_;
+
+    static qint64 readResidentBytes();
+    static qint64 readHeapBytes();
+    static void countObjects(const QObject* object, QHash<const char*, int>& classCounts, int& total);
+    void logTrend(const Sample& baseline) const;
+
+    Q_DISABLE_COPY_MOVE(MemoryMonitor)
+};
+
+#endif  // MEMORYMONITOR_H_
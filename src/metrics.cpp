@@ -0,0 +1,271 @@
+#include "metrics.h"
+
+#include <QTcpSocket>
+#include <QTimer>
+#include <QtAlgorithms>
+
+#include "logging.h"
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+namespace {
+constexpr int CONNECTION_TIMEOUT = 10 * 1000;  // Milliseconds
+constexpr qint64 MAX_REQUEST_LINE = 8 * 1024;  // Bytes
+
+Metrics* instance_ = nullptr;
+
+QByteArray number(const double value) {
+    return QByteArray::number(value, 'g', 10);
+}
+}  // namespace
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void Metrics::Histogram::record(const qint64 microseconds) {
+    quint64 value = static_cast<quint64>(qMax<qint64>(0, microseconds));
+    buckets_[bucketIndex(value)]++;
+    count_++;
+    sum_ += value;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int Metrics::Histogram::bucketIndex(const quint64 value) {
+    if (value < SUB_BUCKET_COUNT) {
+        // Small values get a bucket each.
+        return static_cast<int>(value);
+    }
+
+    // Otherwise, the most significant bits pick the power of two and the linear sub-bucket within it.
+    int shift = (63 - static_cast<int>(qCountLeadingZeroBits(value))) - SUB_BUCKET_BITS;
+    return ((shift + 1) * SUB_BUCKET_COUNT) + static_cast<int>((value >> shift) - SUB_BUCKET_COUNT);
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+quint64 Metrics::Histogram::bucketUpperBound(const int index) {
+    if (index < SUB_BUCKET_COUNT) {
+        return static_cast<quint64>(index);
+    }
+
+    int shift = (index / SUB_BUCKET_COUNT) - 1;
+    quint64 subBucket = static_cast<quint64>((index % SUB_BUCKET_COUNT) + SUB_BUCKET_COUNT);
+    return ((subBucket + 1) << shift) - 1;  // Wraps to the maximum for the very last bucket
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+Metrics::Metrics(QObject* parent) : QObject(parent), port_(0) {
+    setObjectName("Metrics");
+
+    connect(&server_, &QTcpServer::newConnection, this, &Metrics::handleConnection);
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+Metrics* Metrics::instance() {
+    if (!instance_) {
+        instance_ = new Metrics();
+    }
+
+    return instance_;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+Metrics::Counter* Metrics::counter(const QByteArray& name, const QByteArray& help, const Labels& labels) {
+    auto& series = family(name, Type::Counter, help).counters[renderLabels(labels)];
+    if (!series) {
+        series.reset(new Counter());
+    }
+    return series.get();
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+Metrics::Gauge* Metrics::gauge(const QByteArray& name, const QByteArray& help, const Labels& labels) {
+    auto& series = family(name, Type::Gauge, help).gauges[renderLabels(labels)];
+    if (!series) {
+        series.reset(new Gauge());
+    }
+    return series.get();
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+Metrics::Histogram* Metrics::histogram(const QByteArray& name, const QByteArray& help, const Labels& labels) {
+    auto& series = family(name, Type::Histogram, help).histograms[renderLabels(labels)];
+    if (!series) {
+        series.reset(new Histogram());
+    }
+    return series.get();
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void Metrics::addCollector(const std::function<void()>& collector) {
+    if (collector) {
+        collectors_.append(collector);
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+QByteArray Metrics::exposition() {
+    for (const auto& collector : qAsConst(collectors_)) {
+        collector();
+    }
+
+    QByteArray text;
+    for (const auto& entry : families_) {
+        const QByteArray& name = entry.first;
+        const Family& family = entry.second;
+        text += "# HELP " + name + ' ' + family.help + '\n';
+        text += "# TYPE " + name + ' ' + typeName(family.type) + '\n';
+
+        for (const auto& series : family.counters) {
+            text += name + series.first + ' ' + QByteArray::number(series.second->value()) + '\n';
+        }
+        for (const auto& series : family.gauges) {
+            text += name + series.first + ' ' + number(series.second->value()) + '\n';
+        }
+        for (const auto& series : family.histograms) {
+            // Buckets are cumulative. List every one up to the highest with a value, so that a bucket never drops out
+            // of the series once it has appeared, and leave out the empty ones above it.
+            const Histogram& histogram = *series.second;
+            int lastBucket = Histogram::BUCKET_COUNT - 1;
+            while ((lastBucket >= 0) && (histogram.buckets().at(static_cast<size_t>(lastBucket)) == 0)) {
+                lastBucket--;
+            }
+            quint64 cumulativeCount = 0;
+            for (int i = 0; i <= lastBucket; i++) {
+                cumulativeCount += histogram.buckets().at(static_cast<size_t>(i));
+                QByteArray le = "le=\"" + number(Histogram::bucketUpperBound(i) / 1e6) + '"';
+                text += name + "_bucket" + joinLabels(series.first, le) + ' ' + QByteArray::number(cumulativeCount) +
+                        '\n';
+            }
+            text += name + "_bucket" + joinLabels(series.first, "le=\"+Inf\"") + ' ' +
+                    QByteArray::number(histogram.count()) + '\n';
+            text += name + "_sum" + series.first + ' ' + number(histogram.sum() / 1e6) + '\n';
+            text += name + "_count" + series.first + ' ' + QByteArray::number(histogram.count()) + '\n';
+        }
+    }
+
+    return text;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void Metrics::setPort(const int value) {
+    if ((value < 0) || (value > 65535)) {
+        qCWarning(lcMetrics) << "Ignoring request to set invalid metrics port: " << value;
+        return;
+    }
+
+    if (port_ != value) {
+        port_ = value;
+        emit portChanged();
+
+        server_.close();
+        if (port_ > 0) {
+            // Only listen locally, anything scraping from elsewhere should go through a proxy on the panel.
+            if (server_.listen(QHostAddress::LocalHost, static_cast<quint16>(port_))) {
+                qCInfo(lcMetrics) << "Serving metrics on port: " << port_;
+            } else {
+                qCWarning(lcMetrics) << "Failed to serve metrics on port " << port_ << ": " << server_.errorString();
+            }
+        }
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void Metrics::handleConnection() {
+    while (server_.hasPendingConnections()) {
+        QTcpSocket* socket = server_.nextPendingConnection();
+        connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+
+        // Don't let a client that never finishes its request, or never reads the response, hold on to the connection.
+        QTimer::singleShot(CONNECTION_TIMEOUT, socket, [socket] {
+            socket->abort();
+            socket->deleteLater();
+        });
+
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket] {
+            if (!socket->canReadLine()) {
+                // Wait for the whole request line, within reason.
+                if (socket->bytesAvailable() > MAX_REQUEST_LINE) {
+                    socket->abort();
+                }
+                return;
+            }
+
+            // Anything that arrives after the request line is ignored from here on.
+            (void)disconnect(socket, &QTcpSocket::readyRead, this, nullptr);
+
+            // Only the request line matters, everything gets one response before the connection is closed.
+            QList<QByteArray> request = socket->readLine().trimmed().split(' ');
+            QByteArray status = "200 OK";
+            QByteArray body;
+            if ((request.size() < 2) || (request.at(0) != "GET")) {
+                status = "405 Method Not Allowed";
+            } else if ((request.at(1) != "/metrics") && (request.at(1) != "/")) {
+                status = "404 Not Found";
+            } else {
+                body = exposition();
+            }
+
+            socket->write("HTTP/1.1 " + status + "\r\n");
+            socket->write("Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n");
+            socket->write("Content-Length: " + QByteArray::number(body.size()) + "\r\n");
+            socket->write("Connection: close\r\n\r\n");
+            socket->write(body);
+            socket->disconnectFromHost();
+        });
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+Metrics::Family& Metrics::family(const QByteArray& name, const Type type, const QByteArray& help) {
+    auto it = families_.find(name);
+    if (it == families_.end()) {
+        it = families_.emplace(name, Family{type, help, {}, {}, {}}).first;
+    } else if (it->second.type != type) {
+        qCWarning(lcMetrics) << "Metric " << name << " was already registered as a different type";
+    }
+    return it->second;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+QByteArray Metrics::typeName(const Type type) {
+    switch (type) {
+        case Type::Counter:
+            return "counter";
+
+        case Type::Gauge:
+            return "gauge";
+
+        case Type::Histogram:
+        default:
+            return "histogram";
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+QByteArray Metrics::renderLabels(const Labels& labels) {
+    if (labels.isEmpty()) {
+        return QByteArray();
+    }
+
+    QByteArray rendered = "{";
+    for (int i = 0; i < labels.size(); i++) {
+        if (i > 0) {
+            rendered += ',';
+        }
+
+        // Escape the value as the text format requires.
+        QByteArray value = labels.at(i).second.toUtf8();
+        value.replace('\\', "\\\\").replace('"', "\\\"").replace('\n', "\\n");
+        rendered += labels.at(i).first + "=\"" + value + '"';
+    }
+    rendered += '}';
+    return rendered;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+QByteArray Metrics::joinLabels(const QByteArray& labels, const QByteArray& extra) {
+    if (labels.isEmpty()) {
+        return '{' + extra + '}';
+    }
+
+    // Insert before the closing brace.
+    return labels.left(labels.size() - 1) + ',' + extra + '}';
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,121 @@
+#ifndef METRICS_H_
+#define METRICS_H_
+
+#include <QByteArray>
+#include <QObject>
+#include <QPair>
+#include <QString>
+#include <QTcpServer>
+#include <QVector>
+
+#include <array>
+#include <functional>
+#include <map>
+#include <memory>
+
+// In-process registry of counters, gauges, and latency histograms, which can be scraped in the Prometheus text format
+// from a localhost HTTP endpoint. Recording is a handful of integer operations, everything else happens on a scrape.
+class Metrics final : public QObject {
+    Q_OBJECT
+
+    // clang-format off
+    Q_PROPERTY(int port  READ port  WRITE setPort  NOTIFY portChanged)
+    // clang-format on
+
+ public:
+    using Labels = QVector<QPair<QByteArray, QString>>;  // Name, value
+
+    class Counter {
+     public:
+        void increment(quint64 amount = 1) { value_ += amount; }
+        quint64 value() const { return value_; }
+
+     private:
+        quint64 value_ = 0;
+    };
+
+    class Gauge {
+     public:
+        void set(double value) { value_ = value; }
+        void add(double amount) { value_ += amount; }
+        double value() const { return value_; }
+
+     private:
+        double value_ = 0.0;
+    };
+
+    // Buckets values HDR-style, with a fixed number of linear sub-buckets for each power of two. This keeps the
+    // relative error bounded (1/8) from microseconds up to hours without having to pick the bucket boundaries up front.
+    class Histogram {
+     public:
+        static constexpr int SUB_BUCKET_BITS = 3;
+        static constexpr int SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+        static constexpr int BUCKET_COUNT = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT;
+
+        void record(qint64 microseconds);
+        quint64 count() const { return count_; }
+        quint64 sum() const { return sum_; }  // Microseconds
+        const std::array<quint64, BUCKET_COUNT>& buckets() const { return buckets_; }
+
+        static int bucketIndex(quint64 value);
+        static quint64 bucketUpperBound(int index);
+
+     private:
+        std::array<quint64, BUCKET_COUNT> buckets_{};
+        quint64 count_ = 0;
+        quint64 sum_ = 0;
+    };
+
+    static Metrics* instance();
+
+    // The returned metrics stay valid for the life of the registry, so keep them around rather than looking them up for
+    // every recording when the labels do not change.
+    Counter* counter(const QByteArray& name, const QByteArray& help, const Labels& labels = {});
+    Gauge* gauge(const QByteArray& name, const QByteArray& help, const Labels& labels = {});
+    Histogram* histogram(const QByteArray& name, const QByteArray& help, const Labels& labels = {});
+
+    // Collectors are run right before each scrape, for values that are cheaper to read than to keep up to date.
+    void addCollector(const std::function<void()>& collector);
+
+    QByteArray exposition();
+
+    int port() const { return port_; }
+    void setPort(int value);
+
+ signals:
+    void portChanged();
+
+ private slots:
+    void handleConnection();
+
+ private:
+    enum class Type {
+        Counter,
+        Gauge,
+        Histogram,
+    };
+
+    struct Family {
+        Type type;
+        QByteArray help;
+        std::map<QByteArray, std::unique_ptr<Counter>> counters;  // Key: rendered labels
+        std::map<QByteArray, std::unique_ptr<Gauge>> gauges;
+        std::map<QByteArray, std::unique_ptr<Histogram>> histograms;
+    };
+
+    explicit Metrics(QObject* parent = nullptr);
+
+    std::map<QByteArray, Family> families_;  // Key: metric name
+    QVector<std::function<void()>> collectors_;
+    QTcpServer server_;
+    int port_;  // 0 when not serving
+
+    Family& family(const QByteArray& name, Type type, const QByteArray& help);
+    static QByteArray typeName(Type type);
+    static QByteArray renderLabels(const Labels& labels);
+    static QByteArray joinLabels(const QByteArray& labels, const QByteArray& extra);
+
+    Q_DISABLE_COPY_MOVE(Metrics)
+};
+
+#endif  // METRICS_H_
@@ -0,0 +1,207 @@
+#include "nanoleafeffects.h"
+
+#include <QColor>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+
+#include "logging.h"
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+NanoleafEffects::NanoleafEffects(QObject* parent) : QAbstractListModel(parent) {
+    // Nothing else to do.
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+QStringList NanoleafEffects::colors(const QString& name) const {
+    int row = rows_.value(name, -1);
+    return (row >= 0) ? effects_.at(row).colors : QStringList();
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int NanoleafEffects::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : effects_.size();
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+QVariant NanoleafEffects::data(const QModelIndex& index, const int role) const {
+    if (!index.isValid() || (index.row() >= effects_.size())) {
+        return QVariant();
+    }
+
+    const Effect& effect = effects_.at(index.row());
+    switch (role) {
+        case NameRole:
+            return effect.name;
+
+        case ColorsRole:
+            return effect.colors;
+
+        case DelayTimeRole:
+            return effect.delayTime;
+
+        case TransitionTimeRole:
+            return effect.transitionTime;
+
+        default:
+            return QVariant();
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+QHash<int, QByteArray> NanoleafEffects::roleNames() const {
+    return {{NameRole, "name"},
+            {ColorsRole, "colors"},
+            {DelayTimeRole, "delayTime"},
+            {TransitionTimeRole, "transitionTime"}};
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+bool NanoleafEffects::matches(QStringList names) const {
+    std::sort(names.begin(), names.end());
+    return names == names_;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+bool NanoleafEffects::update(const QJsonArray& animations) {
+    // Skip all of the parsing if the content is the same as what the catalog was built from.
+    QByteArray hash =
+        QCryptographicHash::hash(QJsonDocument(animations).toJson(QJsonDocument::Compact), QCryptographicHash::Sha1)
+            .toHex();
+    if (hash_ == hash) {
+        return false;
+    }
+
+    QVector<Effect> effects;
+    effects.reserve(animations.size());
+    for (const auto& animation : animations) {
+        QJsonObject animationObject = animation.toObject();
+        if (animationObject.isEmpty()) {
+            continue;
+        }
+
+        Effect effect{animationObject.value("animName").toString(), {}, 0.0, 0.0};
+
+        const QJsonArray paletteArray = animationObject.value("palette").toArray();
+        effect.colors.reserve(paletteArray.size());
+        for (const auto& palette : paletteArray) {
+            QJsonObject paletteObject = palette.toObject();
+            if (!paletteObject.isEmpty()) {
+                double hue = paletteObject.value("hue").toInt() / 359.0;
+                double saturation = paletteObject.value("saturation").toInt() / 100.0;
+                double brightness = paletteObject.value("brightness").toInt() / 100.0;
+                effect.colors.append(QColor::fromHsvF(hue, saturation, brightness).name());
+            }
+        }
+
+        const QJsonArray optionsArray = animationObject.value("pluginOptions").toArray();
+        for (const auto& option : optionsArray) {
+            QJsonObject optionObject = option.toObject();
+            QString optionName = optionObject.value("name").toString();
+
+            // These values are presented in tenths of a second, convert.
+            if (optionName == "delayTime") {
+                effect.delayTime = optionObject.value("value").toInt() / 10.0;
+            } else if (optionName == "transTime") {
+                effect.transitionTime = optionObject.value("value").toInt() / 10.0;
+            }
+        }
+
+        effects.append(effect);
+    }
+
+    // Sort alphabetically by name.
+    std::sort(effects.begin(), effects.end(), [](const Effect& left, const Effect& right) {
+        return left.name < right.name;
+    });
+
+    reset(effects, hash);
+    return true;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+bool NanoleafEffects::load(const QString& path) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        // No cached catalog yet.
+        return false;
+    }
+
+    QJsonObject cacheObject = QJsonDocument::fromJson(file.readAll()).object();
+    QByteArray hash = cacheObject.value("hash").toString().toUtf8();
+    if (hash.isEmpty()) {
+        qCWarning(lcNanoleaf) << "Ignoring invalid Nanoleaf effects cache: " << path;
+        return false;
+    }
+
+    QVector<Effect> effects;
+    const QJsonArray effectsArray = cacheObject.value("effects").toArray();
+    effects.reserve(effectsArray.size());
+    for (const auto& effect : effectsArray) {
+        QJsonObject effectObject = effect.toObject();
+        effects.append(Effect{effectObject.value("name").toString(),
+                              effectObject.value("colors").toVariant().toStringList(),
+                              effectObject.value("delayTime").toDouble(),
+                              effectObject.value("transitionTime").toDouble()});
+    }
+
+    // The file was written from a sorted catalog, but don't rely on that.
+    std::sort(effects.begin(), effects.end(), [](const Effect& left, const Effect& right) {
+        return left.name < right.name;
+    });
+
+    reset(effects, hash);
+    qCInfo(lcNanoleaf) << "Loaded " << effects_.size() << " cached Nanoleaf effects";
+    return true;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+bool NanoleafEffects::save(const QString& path) const {
+    QJsonArray effectsArray;
+    for (const auto& effect : effects_) {
+        effectsArray.append(QJsonObject{{"name", effect.name},
+                                        {"colors", QJsonArray::fromStringList(effect.colors)},
+                                        {"delayTime", effect.delayTime},
+                                        {"transitionTime", effect.transitionTime}});
+    }
+    QJsonObject cacheObject{{"hash", QString::fromUtf8(hash_)}, {"effects", effectsArray}};
+
+    if (!QDir().mkpath(QFileInfo(path).absolutePath())) {
+        qCWarning(lcNanoleaf) << "Failed to create directory for Nanoleaf effects cache: " << path;
+        return false;
+    }
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(lcNanoleaf) << "Failed to open Nanoleaf effects cache: " << path;
+        return false;
+    }
+    file.write(QJsonDocument(cacheObject).toJson(QJsonDocument::Compact));
+    return file.commit();
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void NanoleafEffects::reset(const QVector<Effect>& effects, const QByteArray& hash) {
+    int previousCount = effects_.size();
+
+    beginResetModel();
+    effects_ = effects;
+    hash_ = hash;
+    rows_.clear();
+    names_.clear();
+    names_.reserve(effects_.size());
+    for (int i = 0; i < effects_.size(); i++) {
+        rows_.insert(effects_.at(i).name, i);
+        names_.append(effects_.at(i).name);
+    }
+    endResetModel();
+
+    if (previousCount != effects_.size()) {
+        emit countChanged();
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,63 @@
+#ifndef NANOLEAFEFFECTS_H_
+#define NANOLEAFEFFECTS_H_
+
+#include <QAbstractListModel>
+#include <QByteArray>
+#include <QHash>
+#include <QJsonArray>
+#include <QStringList>
+#include <QVector>
+
+class NanoleafEffects final : public QAbstractListModel {
+    Q_OBJECT
+
+    // clang-format off
+    Q_PROPERTY(int count  READ count  NOTIFY countChanged)
+    // clang-format on
+
+ public:
+    enum Roles {
+        NameRole = Qt::UserRole + 1,
+        ColorsRole,
+        DelayTimeRole,
+        TransitionTimeRole,
+    };
+
+    struct Effect {
+        QString name;
+        QStringList colors;
+        double delayTime;       // Seconds
+        double transitionTime;  // Seconds
+    };
+
+    explicit NanoleafEffects(QObject* parent = nullptr);
+
+    int count() const { return effects_.size(); }
+    const QByteArray& hash() const { return hash_; }
+    const QStringList& names() const { return names_; }
+    QStringList colors(const QString& name) const;
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    bool matches(QStringList names) const;
+    bool update(const QJsonArray& animations);
+    bool load(const QString& path);
+    bool save(const QString& path) const;
+
+ signals:
+    void countChanged();
+
+ private:
+    QVector<Effect> effects_;   // Sorted by name
+    QHash<QString, int> rows_;  // Key: name, Value: row
+    QStringList names_;         // Sorted, matching the rows
+    QByteArray hash_;           // Hash of the content the catalog was built from
+
+    void reset(const QVector<Effect>& effects, const QByteArray& hash);
+
+    Q_DISABLE_COPY_MOVE(NanoleafEffects)
+};
+
+#endif  // NANOLEAFEFFECTS_H_
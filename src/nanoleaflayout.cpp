@@ -0,0 +1,240 @@
+#include "nanoleaflayout.h"
+
+#include <QJsonArray>
+#include <QtMath>
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+namespace {
+constexpr double LINE_WIDTH_RATIO = 0.1;
+
+QPointF rotate(const QPointF& point, const double degrees) {
+    double radians = qDegreesToRadians(degrees);
+    return {(point.x() * qCos(radians)) - (point.y() * qSin(radians)),
+            (point.x() * qSin(radians)) + (point.y() * qCos(radians))};
+}
+}  // namespace
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+NanoleafLayout::NanoleafLayout(QObject* parent)
+    : QAbstractListModel(parent), aspectRatio_(1.0), globalOrientation_(0.0) {
+    // Nothing else to do.
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+QVector<int> NanoleafLayout::panelIDs() const {
+    QVector<int> ids;
+    ids.reserve(panels_.size());
+    for (const auto& panel : panels_) {
+        ids.append(panel.id);
+    }
+    return ids;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int NanoleafLayout::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : panels_.size();
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+QVariant NanoleafLayout::data(const QModelIndex& index, const int role) const {
+    if (!index.isValid() || (index.row() >= panels_.size())) {
+        return QVariant();
+    }
+
+    const Panel& panel = panels_.at(index.row());
+    switch (role) {
+        case PanelIDRole:
+            return panel.id;
+
+        case ShapeTypeRole:
+            return panel.shapeType;
+
+        case VerticesRole: {
+            // Close the outline for drawing.
+            QVariantList vertices;
+            for (const auto& vertex : panel.vertices) {
+                vertices.append(vertex);
+            }
+            if (!panel.vertices.isEmpty()) {
+                vertices.append(panel.vertices.first());
+            }
+            return vertices;
+        }
+
+        case CenterRole:
+            return panel.center;
+
+        case PanelColorRole:
+            return panel.color.isValid() ? QVariant(panel.color) : QVariant();
+
+        default:
+            return QVariant();
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+QHash<int, QByteArray> NanoleafLayout::roleNames() const {
+    return {{PanelIDRole, "panelID"},
+            {ShapeTypeRole, "shapeType"},
+            {VerticesRole, "vertices"},
+            {CenterRole, "center"},
+            {PanelColorRole, "panelColor"}};
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+bool NanoleafLayout::update(const QJsonObject& layout, const double globalOrientation) {
+    if ((layout_ == layout) && (globalOrientation_ == globalOrientation)) {
+        // Nothing changed, keep the existing geometry (and colors).
+        return false;
+    }
+    layout_ = layout;
+    globalOrientation_ = globalOrientation;
+
+    // Build the outline of each panel in the Nanoleaf coordinate space, where Y increases upwards.
+    QVector<Panel> panels;
+    QRectF bounds;
+    const QJsonArray positionArray = layout.value("positionData").toArray();
+    for (const auto& position : positionArray) {
+        QJsonObject positionObject = position.toObject();
+        int shapeType = positionObject.value("shapeType").toInt();
+        int sides = sideCount(shapeType);
+        if (sides == 0) {
+            // Controllers and connectors do not light up, leave them out.
+            continue;
+        }
+
+        QPointF center(positionObject.value("x").toDouble(), positionObject.value("y").toDouble());
+        double orientation = positionObject.value("o").toDouble();
+        double length = sideLength(shapeType);
+
+        QPolygonF vertices;
+        if (sides == 2) {
+            // Lines are drawn as thin bars along their orientation.
+            double halfLength = length / 2.0;
+            double halfWidth = (length * LINE_WIDTH_RATIO) / 2.0;
+            vertices << QPointF(-halfLength, -halfWidth) << QPointF(halfLength, -halfWidth)
+                     << QPointF(halfLength, halfWidth) << QPointF(-halfLength, halfWidth);
+            for (auto& vertex : vertices) {
+                vertex = center + rotate(vertex, orientation);
+            }
+        } else {
+            // Regular polygons, with triangles pointing up and squares sitting flat when not rotated.
+            double radius = length / (2.0 * qSin(M_PI / sides));
+            double startAngle = (sides == 3) ? 90.0 : (180.0 / sides);
+            for (int i = 0; i < sides; i++) {
+                vertices << center + rotate(QPointF(radius, 0.0), startAngle + orientation + ((360.0 / sides) * i));
+            }
+        }
+
+        // Apply the orientation of the whole layout.
+        for (auto& vertex : vertices) {
+            vertex = rotate(vertex, globalOrientation);
+        }
+        center = rotate(center, globalOrientation);
+
+        bounds = bounds.isNull() ? vertices.boundingRect() : bounds.united(vertices.boundingRect());
+        panels.append(Panel{positionObject.value("panelId").toInt(), shapeType, vertices, center, QColor()});
+    }
+
+    // Normalize into the bounding box with Y increasing downwards for display.
+    double width = qMax(bounds.width(), 1.0);
+    double height = qMax(bounds.height(), 1.0);
+    auto normalize = [&bounds, width, height](const QPointF& point) {
+        return QPointF((point.x() - bounds.left()) / width, (bounds.bottom() - point.y()) / height);
+    };
+    for (auto& panel : panels) {
+        for (auto& vertex : panel.vertices) {
+            vertex = normalize(vertex);
+        }
+        panel.center = normalize(panel.center);
+    }
+
+    // Carry over any colors for panels that still exist.
+    for (auto& panel : panels) {
+        int row = panelRows_.value(panel.id, -1);
+        if (row >= 0) {
+            panel.color = panels_.at(row).color;
+        }
+    }
+
+    int previousCount = panels_.size();
+    beginResetModel();
+    panels_ = panels;
+    panelRows_.clear();
+    for (int i = 0; i < panels_.size(); i++) {
+        panelRows_.insert(panels_.at(i).id, i);
+    }
+    endResetModel();
+
+    if (previousCount != panels_.size()) {
+        emit countChanged();
+    }
+    double aspectRatio = width / height;
+    if (aspectRatio_ != aspectRatio) {
+        aspectRatio_ = aspectRatio;
+        emit aspectRatioChanged();
+    }
+
+    return true;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void NanoleafLayout::setPanelColor(const int id, const QColor& color) {
+    int row = panelRows_.value(id, -1);
+    if ((row >= 0) && (panels_.at(row).color != color)) {
+        panels_[row].color = color;
+        QModelIndex modelIndex = index(row);
+        emit dataChanged(modelIndex, modelIndex, {PanelColorRole});
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int NanoleafLayout::sideCount(const int shapeType) {
+    switch (shapeType) {
+        case 0:  // Triangle
+        case 8:  // Shapes triangle
+        case 9:  // Shapes mini triangle
+            return 3;
+
+        case 2:  // Square
+        case 3:  // Control square primary
+        case 4:  // Control square passive
+            return 4;
+
+        case 7:   // Shapes hexagon
+        case 14:  // Elements hexagon
+            return 6;
+
+        case 17:  // Lines
+        case 18:  // Lines single zone
+            return 2;
+
+        default:
+            return 0;
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+double NanoleafLayout::sideLength(const int shapeType) {
+    switch (shapeType) {
+        case 0:
+            return 150.0;
+        case 2:
+        case 3:
+        case 4:
+            return 100.0;
+        case 7:
+        case 9:
+            return 67.0;
+        case 8:
+        case 14:
+            return 134.0;
+        case 17:
+            return 154.0;
+        case 18:
+            return 77.0;
+        default:
+            return 0.0;
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,66 @@
+#ifndef NANOLEAFLAYOUT_H_
+#define NANOLEAFLAYOUT_H_
+
+#include <QAbstractListModel>
+#include <QColor>
+#include <QJsonObject>
+#include <QPolygonF>
+#include <QVector>
+
+class NanoleafLayout final : public QAbstractListModel {
+    Q_OBJECT
+
+    // clang-format off
+    Q_PROPERTY(int count            READ count        NOTIFY countChanged)
+    Q_PROPERTY(double aspectRatio   READ aspectRatio  NOTIFY aspectRatioChanged)
+    // clang-format on
+
+ public:
+    enum Roles {
+        PanelIDRole = Qt::UserRole + 1,
+        ShapeTypeRole,
+        VerticesRole,
+        CenterRole,
+        PanelColorRole,
+    };
+
+    struct Panel {
+        int id;
+        int shapeType;
+        QPolygonF vertices;  // Normalized to the bounding box of the whole layout
+        QPointF center;
+        QColor color;
+    };
+
+    explicit NanoleafLayout(QObject* parent = nullptr);
+
+    int count() const { return panels_.size(); }
+    double aspectRatio() const { return aspectRatio_; }
+    const QVector<Panel>& panels() const { return panels_; }
+    QVector<int> panelIDs() const;
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    bool update(const QJsonObject& layout, double globalOrientation = 0.0);
+    void setPanelColor(int id, const QColor& color);
+
+ signals:
+    void countChanged();
+    void aspectRatioChanged();
+
+ private:
+    QVector<Panel> panels_;
+    QHash<int, int> panelRows_;  // Key: panel ID, Value: row
+    double aspectRatio_;
+    QJsonObject layout_;
+    double globalOrientation_;
+
+    static int sideCount(int shapeType);
+    static double sideLength(int shapeType);
+
+    Q_DISABLE_COPY_MOVE(NanoleafLayout)
+};
+
+#endif  // NANOLEAFLAYOUT_H_
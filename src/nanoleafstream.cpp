@@ -0,0 +1,107 @@
+#include "nanoleafstream.h"
+
+#include <QDataStream>
+
+#include "logging.h"
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+namespace {
+constexpr int MAX_FRAME_RATE = 60;
+}  // namespace
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+NanoleafStream::NanoleafStream(QObject* parent)
+    : QObject(parent), port_(DEFAULT_PORT), frameRate_(10), transitionTime_(1) {
+    // Frames are only sent on the timer, which caps the rate no matter how often colors are changed.
+    frameTimer_.setInterval(1000 / frameRate_);
+    frameTimer_.setSingleShot(false);
+    frameTimer_.setTimerType(Qt::PreciseTimer);
+    connect(&frameTimer_, &QTimer::timeout, this, &NanoleafStream::sendFrame);
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void NanoleafStream::setFrameRate(const int value) {
+    if ((value <= 0) || (value > MAX_FRAME_RATE)) {
+        qCWarning(lcNanoleaf) << "Ignoring request to set invalid Nanoleaf stream frame rate: " << value;
+        return;
+    }
+
+    frameRate_ = value;
+    frameTimer_.setInterval(1000 / frameRate_);
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void NanoleafStream::setDestination(const QHostAddress& address, const quint16 port) {
+    address_ = address;
+    port_ = port;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void NanoleafStream::start() {
+    if (address_.isNull()) {
+        qCWarning(lcNanoleaf) << "Not starting Nanoleaf stream without a destination";
+        return;
+    }
+
+    // Send the whole buffer first so the panels match it.
+    for (auto it = frameBuffer_.constBegin(); it != frameBuffer_.constEnd(); ++it) {
+        dirtyPanels_.insert(it.key());
+    }
+    frameTimer_.start();
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void NanoleafStream::stop() {
+    frameTimer_.stop();
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void NanoleafStream::setPanelColor(const int id, const QColor& color) {
+    auto it = frameBuffer_.find(id);
+    if ((it == frameBuffer_.end()) || (it.value() != color)) {
+        frameBuffer_.insert(id, color);
+        dirtyPanels_.insert(id);
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+QByteArray NanoleafStream::encodeFrame(const QVector<PanelColor>& panels, const int transitionTime) {
+    // Version 2 of the protocol uses big endian, with 2 bytes for the panel count, panel IDs, and transition time.
+    QByteArray frame;
+    frame.reserve(2 + (panels.size() * 8));
+    QDataStream stream(&frame, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::BigEndian);
+
+    stream << static_cast<quint16>(panels.size());
+    for (const auto& panel : panels) {
+        stream << static_cast<quint16>(panel.id) << static_cast<quint8>(panel.color.red())
+               << static_cast<quint8>(panel.color.green()) << static_cast<quint8>(panel.color.blue())
+               << static_cast<quint8>(0)  // White channel, unused
+               << static_cast<quint16>(transitionTime);
+    }
+
+    return frame;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void NanoleafStream::sendFrame() {
+    if (dirtyPanels_.isEmpty()) {
+        // Nothing changed since the last frame.
+        return;
+    }
+
+    // Only the panels that changed need to be sent.
+    QVector<PanelColor> panels;
+    panels.reserve(dirtyPanels_.size());
+    for (int id : qAsConst(dirtyPanels_)) {
+        panels.append(PanelColor{id, frameBuffer_.value(id)});
+    }
+    dirtyPanels_.clear();
+
+    QByteArray frame = encodeFrame(panels, transitionTime_);
+    if (socket_.writeDatagram(frame, address_, port_) != frame.size()) {
+        qCWarning(lcNanoleaf) << "Failed to send Nanoleaf stream frame: " << socket_.errorString();
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
@@ -0,0 +1,54 @@
+#ifndef NANOLEAFSTREAM_H_
+#define NANOLEAFSTREAM_H_
+
+#include <QByteArray>
+#include <QColor>
+#include <QHash>
+#include <QHostAddress>
+#include <QObject>
+#include <QSet>
+#include <QTimer>
+#include <QUdpSocket>
+#include <QVector>
+
+// Sends per-panel colors to a Nanoleaf using the external control (v2) UDP streaming protocol.
+class NanoleafStream final : public QObject {
+    Q_OBJECT
+
+ public:
+    static constexpr quint16 DEFAULT_PORT = 60222;
+
+    explicit NanoleafStream(QObject* parent = nullptr);
+
+    int frameRate() const { return frameRate_; }
+    void setFrameRate(int value);
+    void setDestination(const QHostAddress& address, quint16 port = DEFAULT_PORT);
+
+    void start();
+    void stop();
+    void setPanelColor(int id, const QColor& color);
+
+ private slots:
+    void sendFrame();
+
+ private:
+    struct PanelColor {
+        int id;
+        QColor color;
+    };
+
+    QUdpSocket socket_;
+    QHostAddress address_;
+    quint16 port_;
+    int frameRate_;
+    int transitionTime_;  // Tenths of a second
+    QTimer frameTimer_;
+    QHash<int, QColor> frameBuffer_;  // Key: panel ID, Value: color
+    QSet<int> dirtyPanels_;
+
+    static QByteArray encodeFrame(const QVector<PanelColor>& panels, int transitionTime);
+
+    Q_DISABLE_COPY_MOVE(NanoleafStream)
+};
+
+#endif  // NANOLEAFSTREAM_H_
@@ -0,0 +1,225 @@
+#include "networkcapture.h"
+
+#include <QTimer>
+
+#include <cstring>
+#include <limits>
+
+#include "logging.h"
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+namespace {
+constexpr quint32 MAGIC = 0x56434e43;  // "VCNC"
+constexpr quint16 VERSION = 1;
+}  // namespace
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+bool NetworkCapture::open(const QString& path) {
+    file_.setFileName(path);
+    if (!file_.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qCWarning(lcNetwork) << "Failed to open network capture: " << path;
+        return false;
+    }
+
+    stream_.setDevice(&file_);
+    stream_.setVersion(QDataStream::Qt_5_15);
+    stream_ << MAGIC << VERSION;
+    (void)file_.flush();
+    return true;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void NetworkCapture::record(const Exchange& exchange) {
+    if (!isOpen()) {
+        return;
+    }
+
+    // Reply bodies are almost all JSON, which compresses well enough to keep a day of polling small.
+    stream_ << static_cast<quint8>(ExchangeRecord) << exchange.time << exchange.latency
+            << static_cast<qint32>(exchange.operation) << exchange.url << static_cast<qint32>(exchange.statusCode)
+            << exchange.contentType << qCompress(exchange.body);
+
+    // Flush each record so that a capture is still usable if the application is killed.
+    (void)file_.flush();
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void NetworkCapture::record(const ZeroConfResult& result) {
+    if (!isOpen()) {
+        return;
+    }
+
+    stream_ << static_cast<quint8>(ZeroConfRecord) << result.time << result.serviceType << result.ipAddress;
+    (void)file_.flush();
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+bool NetworkCapture::read(const QString& path, QVector<Exchange>& exchanges, QVector<ZeroConfResult>& zeroConfResults) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qCWarning(lcNetwork) << "Failed to open network capture: " << path;
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_15);
+    quint32 magic = 0;
+    quint16 version = 0;
+    stream >> magic >> version;
+    if ((magic != MAGIC) || (version != VERSION)) {
+        qCWarning(lcNetwork) << "Ignoring unrecognized network capture: " << path;
+        return false;
+    }
+
+    while (!stream.atEnd()) {
+        quint8 type = 0;
+        stream >> type;
+        if (type == ExchangeRecord) {
+            Exchange exchange{0, 0, 0, QUrl(), 0, QByteArray(), QByteArray()};
+            qint32 operation = 0;
+            qint32 statusCode = 0;
+            QByteArray body;
+            stream >> exchange.time >> exchange.latency >> operation >> exchange.url >> statusCode >>
+                exchange.contentType >> body;
+            exchange.operation = operation;
+            exchange.statusCode = statusCode;
+            exchange.body = qUncompress(body);
+            exchanges.append(exchange);
+        } else if (type == ZeroConfRecord) {
+            ZeroConfResult result{0, QString(), QString()};
+            stream >> result.time >> result.serviceType >> result.ipAddress;
+            zeroConfResults.append(result);
+        } else {
+            stream.setStatus(QDataStream::ReadCorruptData);
+        }
+
+        if (stream.status() != QDataStream::Ok) {
+            // Most likely cut off part way through the last record, keep what was read before it.
+            qCWarning(lcNetwork) << "Stopped reading network capture at a damaged record: " << path;
+            break;
+        }
+    }
+
+    qCInfo(lcNetwork) << "Loaded network capture with " << exchanges.size() << " replies and "
+                      << zeroConfResults.size() << " ZeroConf services: " << path;
+    return true;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+ReplayNetworkAccessManager::ReplayNetworkAccessManager(const QVector<NetworkCapture::Exchange>& exchanges,
+                                                       const double speed,
+                                                       QObject* parent)
+    : QNetworkAccessManager(parent), exchanges_(exchanges), speed_(speed) {
+    for (int i = 0; i < exchanges_.size(); i++) {
+        const NetworkCapture::Exchange& exchange = exchanges_.at(i);
+        matches_[matchKey(exchange.operation, exchange.url)].append(i);
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+qint64 ReplayNetworkAccessManager::scaled(const qint64 milliseconds) const {
+    return (speed_ > 0.0) ? qRound64(milliseconds / speed_) : 0;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+QNetworkReply* ReplayNetworkAccessManager::createRequest(const Operation operation,
+                                                         const QNetworkRequest& request,
+                                                         QIODevice* outgoingData) {
+    (void)outgoingData;
+
+    QString key = matchKey(operation, request.url());
+    auto it = matches_.constFind(key);
+    if (it == matches_.constEnd()) {
+        // Act like the server could not be reached.
+        qCWarning(lcNetwork) << "No recorded reply for request: " << key;
+        return new ReplayReply(operation, request, 0, QByteArray(), QByteArray(), 0, this);
+    }
+
+    int& nextMatch = nextMatches_[key];
+    const NetworkCapture::Exchange& exchange = exchanges_.at(it->at(nextMatch));
+    if (nextMatch < (it->size() - 1)) {
+        nextMatch++;
+    }
+    return new ReplayReply(
+        operation, request, exchange.statusCode, exchange.contentType, exchange.body, scaled(exchange.latency), this);
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+QString ReplayNetworkAccessManager::matchKey(const int operation, const QUrl& url) {
+    return QString("%1 %2?%3").arg(operation).arg(url.path(), url.query(QUrl::FullyEncoded));
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+ReplayReply::ReplayReply(const QNetworkAccessManager::Operation operation,
+                         const QNetworkRequest& request,
+                         const int statusCode,
+                         const QByteArray& contentType,
+                         const QByteArray& body,
+                         const qint64 delay,
+                         QObject* parent)
+    : QNetworkReply(parent), body_(body), offset_(0) {
+    setOperation(operation);
+    setRequest(request);
+    setUrl(request.url());
+
+    // A status code of 0 means that no response was ever received.
+    if (statusCode > 0) {
+        setAttribute(QNetworkRequest::HttpStatusCodeAttribute, statusCode);
+        if (statusCode >= 400) {
+            setError(QNetworkReply::UnknownContentError, QString("Recorded status code %1").arg(statusCode));
+        }
+    } else {
+        setError(QNetworkReply::HostNotFoundError, "No recorded reply");
+    }
+    if (!contentType.isEmpty()) {
+        setHeader(QNetworkRequest::ContentTypeHeader, contentType);
+    }
+    setHeader(QNetworkRequest::ContentLengthHeader, body_.size());
+
+    (void)open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+    QTimer::singleShot(static_cast<int>(qMin(delay, qint64(std::numeric_limits<int>::max()))), this, [this] {
+        finish();
+    });
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void ReplayReply::abort() {
+    if (!isFinished()) {
+        setError(QNetworkReply::OperationCanceledError, "Operation canceled");
+        finish();
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+qint64 ReplayReply::bytesAvailable() const {
+    return (body_.size() - offset_) + QIODevice::bytesAvailable();
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+qint64 ReplayReply::readData(char* data, const qint64 maxSize) {
+    qint64 size = qMin(maxSize, body_.size() - offset_);
+    if (size <= 0) {
+        return isFinished() ? -1 : 0;
+    }
+
+    memcpy(data, body_.constData() + offset_, static_cast<size_t>(size));
+    offset_ += size;
+    return size;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void ReplayReply::finish() {
+    if (isFinished()) {
+        return;
+    }
+
+    setFinished(true);
+    if (error() != QNetworkReply::NoError) {
+        emit errorOccurred(error());
+    }
+    if (!body_.isEmpty()) {
+        emit readyRead();
+    }
+    emit finished();
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,116 @@
+#ifndef NETWORKCAPTURE_H_
+#define NETWORKCAPTURE_H_
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QFile>
+#include <QHash>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QString>
+#include <QUrl>
+#include <QVector>
+
+// Records the replies seen by the network interface, and the ZeroConf services it found, to a compact file that can be
+// played back later without any of the devices or services present.
+class NetworkCapture final {
+ public:
+    struct Exchange {
+        qint64 time;     // Milliseconds since the start of the capture, when the request was sent
+        qint64 latency;  // Milliseconds until the reply was received
+        int operation;   // QNetworkAccessManager::Operation
+        QUrl url;
+        int statusCode;
+        QByteArray contentType;
+        QByteArray body;
+    };
+
+    struct ZeroConfResult {
+        qint64 time;  // Milliseconds since the start of the capture
+        QString serviceType;
+        QString ipAddress;
+    };
+
+    NetworkCapture() = default;
+
+    bool open(const QString& path);
+    bool isOpen() const { return file_.isOpen(); }
+    void record(const Exchange& exchange);
+    void record(const ZeroConfResult& result);
+
+    static bool read(const QString& path, QVector<Exchange>& exchanges, QVector<ZeroConfResult>& zeroConfResults);
+
+ private:
+    enum RecordType : quint8 {
+        ExchangeRecord = 1,
+        ZeroConfRecord,
+    };
+
+    QFile file_;
+    QDataStream stream_;
+
+    Q_DISABLE_COPY_MOVE(NetworkCapture)
+};
+
+// Answers requests from a capture instead of the network. Requests are matched on their operation, path, and query, so
+// a capture from one home plays back no matter what addresses the devices end up with, and repeated requests are
+// answered with each recorded reply in turn, sticking with the last one. Replies are delayed by their recorded latency
+// divided by the speed, or sent right away with a speed of 0.
+class ReplayNetworkAccessManager final : public QNetworkAccessManager {
+    Q_OBJECT
+
+ public:
+    ReplayNetworkAccessManager(const QVector<NetworkCapture::Exchange>& exchanges,
+                               double speed,
+                               QObject* parent = nullptr);
+
+    double speed() const { return speed_; }
+    qint64 scaled(qint64 milliseconds) const;
+
+ protected:
+    QNetworkReply* createRequest(Operation operation,
+                                 const QNetworkRequest& request,
+                                 QIODevice* outgoingData = nullptr) override;
+
+ private:
+    QVector<NetworkCapture::Exchange> exchanges_;
+    QHash<QString, QVector<int>> matches_;  // Key: operation, path, and query, Value: exchanges in recorded order
+    QHash<QString, int> nextMatches_;       // Key: operation, path, and query, Value: position in the matches
+    double speed_;
+
+    static QString matchKey(int operation, const QUrl& url);
+
+    Q_DISABLE_COPY_MOVE(ReplayNetworkAccessManager)
+};
+
+// A reply with canned content, which finishes on its own after a delay.
+class ReplayReply final : public QNetworkReply {
+    Q_OBJECT
+
+ public:
+    ReplayReply(QNetworkAccessManager::Operation operation,
+                const QNetworkRequest& request,
+                int statusCode,
+                const QByteArray& contentType,
+                const QByteArray& body,
+                qint64 delay,
+                QObject* parent = nullptr);
+
+    void abort() override;
+    qint64 bytesAvailable() const override;
+    bool isSequential() const override { return true; }
+
+ protected:
+    qint64 readData(char* data, qint64 maxSize) override;
+
+ private:
+    QByteArray body_;
+    qint64 offset_;
+
+    void finish();
+
+    Q_DISABLE_COPY_MOVE(ReplayReply)
+};
+
+#endif  // NETWORKCAPTURE_H_
@@ -1,28 +1,62 @@
 #include "networkinterface.h"
 
 #include <QCoreApplication>
+
+#include "logging.h"
+#include "metrics.h"
+#include "profiler.h"
 /*--------------------------------------------------------------------------------------------------------------------*/
 
 namespace {
 constexpr const char* JSON_CONTENT_TYPE = "application/json";
+constexpr const char* PRECONNECT_SCHEME = "preconnect-https";  // What Qt gives the replies to preconnects
+constexpr quint16 HTTPS_PORT = 443;
+constexpr int MAX_IN_FLIGHT_PER_HOST = 8;
+constexpr int FAILURE_THRESHOLD = 3;        // Failures in a row before opening the circuit
+constexpr int MIN_BACKOFF = 5 * 1000;       // Milliseconds
+constexpr int MAX_BACKOFF = 5 * 60 * 1000;  // Milliseconds
 
 NetworkInterface* instance_ = nullptr;
 }  // namespace
 /*--------------------------------------------------------------------------------------------------------------------*/
 
 NetworkInterface::NetworkInterface(QObject* parent)
-    : QObject(parent), manager_(new QNetworkAccessManager(this)), zeroConf_(new QZeroConf(this)) {
+    : QObject(parent),
+      manager_(new QNetworkAccessManager(this)),
+      zeroConf_(new QZeroConf(this)),
+      requestTimeout_(10 * 1000),
+      captureStartTime_(0),
+      replayManager_(nullptr) {
     setObjectName("NetworkInterface");
 
     connect(manager_, &QNetworkAccessManager::finished, this, &NetworkInterface::handleReply);
+    connect(manager_, &QNetworkAccessManager::encrypted, this, &NetworkInterface::handleEncrypted);
+    clock_.start();
     connect(zeroConf_, &QZeroConf::serviceAdded, this, &NetworkInterface::handleZeroConfServiceAdded);
 
+    // Offer HTTP/2 on every HTTPS connection, and keep TLS sessions around to resume rather than renegotiate.
+    sslConfiguration_ = QSslConfiguration::defaultConfiguration();
+    sslConfiguration_.setAllowedNextProtocols(
+        {QSslConfiguration::ALPNProtocolHTTP2, QSslConfiguration::NextProtocolHttp1_1});
+    sslConfiguration_.setSslOption(QSsl::SslOptionDisableSessionPersistence, false);
+
+    // Publish how often HTTPS requests found a connection ready when metrics are scraped.
+    Metrics::instance()->addCollector([this] {
+        for (auto it = connectionStats_.constBegin(); it != connectionStats_.constEnd(); ++it) {
+            Metrics::instance()
+                ->gauge("vc_connection_reuse_ratio",
+                        "Share of HTTPS requests sent without a new TLS handshake.",
+                        {{"host", it.key()}})
+                ->set(connectionReuseRatio(it.key()));
+        }
+    });
+
     // Configure a timeout on browsing for ZeroConf services.
     zeroConfBrowseTimer_.setInterval(15 * 1000);
     zeroConfBrowseTimer_.setSingleShot(true);
     connect(&zeroConfBrowseTimer_, &QTimer::timeout, this, [this] {
         QString serviceType = zeroConfBrowseRequests_.dequeue();
-        qDebug() << "Failed to find ZeroConf service type: " << serviceType;
+        qCWarning(lcNetwork) << "Failed to find ZeroConf service type: " << serviceType;
         zeroConf_->stopBrowser();
 
         // Are there more requests pending?
@@ -43,18 +77,127 @@ NetworkInterface* NetworkInterface::instance() {
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
 
+void NetworkInterface::setRequestTimeout(const int value) {
+    if ((requestTimeout_ != value) && (value > 0)) {
+        requestTimeout_ = value;
+        emit requestTimeoutChanged();
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+NetworkInterface::CircuitState NetworkInterface::circuitState(const QString& host) const {
+    auto it = hostHealth_.constFind(host);
+    return (it != hostHealth_.constEnd()) ? it->state : CircuitState::Closed;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+bool NetworkInterface::isReachable(const QObject* sender) const {
+    if (!sender) {
+        return true;
+    }
+
+    for (const auto& health : hostHealth_) {
+        if ((health.state != CircuitState::Closed) && health.senders.contains(sender->objectName())) {
+            return false;
+        }
+    }
+    return true;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void NetworkInterface::addKnownHost(const QUrl& url) {
+    if ((url.scheme() == "https") && !knownHosts_.contains(url.host())) {
+        knownHosts_.insert(url.host());
+
+        // Have a connection ready for the first request.
+        if (!replayManager_) {
+            manager_->connectToHostEncrypted(url.host(), HTTPS_PORT, sslConfiguration_);
+        }
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void NetworkInterface::preconnect() {
+    if (replayManager_) {
+        // Nothing to connect to.
+        return;
+    }
+
+    for (const auto& host : qAsConst(knownHosts_)) {
+        if (circuitState(host) == CircuitState::Closed) {
+            qCDebug(lcNetwork) << "Preconnecting to: " << host;
+            manager_->connectToHostEncrypted(host, HTTPS_PORT, sslConfiguration_);
+        }
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+double NetworkInterface::connectionReuseRatio(const QString& host) const {
+    ConnectionStats stats = connectionStats_.value(host);
+    if (stats.requestCount == 0) {
+        return 0.0;
+    }
+
+    quint64 reusedCount = (stats.requestCount > stats.handshakeCount) ? (stats.requestCount - stats.handshakeCount) : 0;
+    return static_cast<double>(reusedCount) / static_cast<double>(stats.requestCount);
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
 void NetworkInterface::sendRequest(const QUrl& destination,
                                    QObject* sender,
                                    QNetworkAccessManager::Operation requestType,
                                    const QByteArray& body,
                                    const QByteArray& contentType,
-                                   const QByteArray& authorization) {
+                                   const QByteArray& authorization,
+                                   const int timeout) {
     if (!destination.isValid()) {
-        qDebug() << "Ignoring request with invalid URL";
+        qCWarning(lcNetwork) << "Ignoring request with invalid URL";
+        return;
+    }
+
+    // Turn away unsupported requests up front, since one let through as the probe of a host that is down would leave
+    // the host waiting on a reply that never comes.
+    if ((requestType != QNetworkAccessManager::GetOperation) && (requestType != QNetworkAccessManager::PostOperation) &&
+        (requestType != QNetworkAccessManager::PutOperation) &&
+        (requestType != QNetworkAccessManager::DeleteOperation)) {
+        qCWarning(lcNetwork) << "Ignoring unsupported request type";
+        return;
+    }
+
+    // Wait on an identical GET that is already in flight rather than sending another, like when a device is slow to
+    // answer and the next poll comes around.
+    QString host = destination.host();
+    QString key;
+    if (requestType == QNetworkAccessManager::GetOperation) {
+        key = sharingKey(destination, authorization);
+        QNetworkReply* sharedReply = sharedReplies_.value(key);
+        if (sharedReply) {
+            addSender(sharedReply, sender);
+            hostMetrics(host).sharedRequests->increment();
+            return;
+        }
+    }
+
+    // Drop anything past what a host should ever need at once, since it is not keeping up.
+    if (inFlightCount(host) >= MAX_IN_FLIGHT_PER_HOST) {
+        qCWarning(lcNetwork) << "Dropping request because too many are in flight to: " << host;
+        hostMetrics(host).droppedRequests->increment();
+        return;
+    }
+
+    // Leave hosts that are down alone, apart from the odd probe to see whether they are back.
+    if (!allowRequest(host, sender)) {
+        hostMetrics(host).suppressedRequests->increment();
         return;
     }
 
     QNetworkRequest request(destination);
+    request.setTransferTimeout((timeout > 0) ? timeout : requestTimeout_);
+    if (destination.scheme() == "https") {
+        request.setSslConfiguration(sslConfiguration_);
+        request.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
+        connectionStats_[host].requestCount++;
+    }
 
     // Attach the application information to the request.
     static QByteArray applicationInfo =
@@ -76,27 +219,40 @@ void NetworkInterface::sendRequest(const QUrl& destination,
         request.setRawHeader("Authorization", authorization);
     }
 
+    QNetworkReply* reply = nullptr;
     switch (requestType) {
         case QNetworkAccessManager::GetOperation:
-            manager_->get(request);
+            reply = manager_->get(request);
             break;
 
         case QNetworkAccessManager::PostOperation:
-            manager_->post(request, body);
+            reply = manager_->post(request, body);
             break;
 
         case QNetworkAccessManager::PutOperation:
-            manager_->put(request, body);
+            reply = manager_->put(request, body);
             break;
 
         case QNetworkAccessManager::DeleteOperation:
-            manager_->deleteResource(request);
+            reply = manager_->deleteResource(request);
             break;
 
         default:
-            qDebug() << "Ignoring unsupported request type";
             break;
     }
+
+    if (reply) {
+        const SenderMetrics& metrics = senderMetrics(host, sender ? sender->objectName() : QString());
+        metrics.requests->increment();
+        metrics.requestBytes->increment(static_cast<quint64>(body.size()));
+
+        pendingRequests_.insert(reply, PendingRequest{clock_.nsecsElapsed() / 1000, host, key, {}});
+        if (!key.isEmpty()) {
+            sharedReplies_.insert(key, reply);
+        }
+        addSender(reply, sender);
+        updateInFlightCount(host, 1);
+    }
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
 
@@ -104,15 +260,26 @@ void NetworkInterface::sendJSONRequest(const QUrl& destination,
                                        QObject* sender,
                                        QNetworkAccessManager::Operation requestType,
                                        const QJsonDocument& body,
-                                       const QByteArray& authorization) {
-    sendRequest(
-        destination, sender, requestType, body.toJson(QJsonDocument::Compact), JSON_CONTENT_TYPE, authorization);
+                                       const QByteArray& authorization,
+                                       const int timeout) {
+    sendRequest(destination,
+                sender,
+                requestType,
+                body.toJson(QJsonDocument::Compact),
+                JSON_CONTENT_TYPE,
+                authorization,
+                timeout);
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
 
 void NetworkInterface::browseZeroConf(const QString& serviceType) {
     if (serviceType.isEmpty()) {
-        qDebug() << "Ignoring request to browse for empty ZeroConf service";
+        qCWarning(lcNetwork) << "Ignoring request to browse for empty ZeroConf service";
+        return;
+    }
+
+    if (replayManager_) {
+        replayZeroConf(serviceType);
         return;
     }
 
@@ -125,28 +292,247 @@ void NetworkInterface::browseZeroConf(const QString& serviceType) {
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
 
+bool NetworkInterface::startCapture(const QString& path) {
+    if (replayManager_) {
+        qCWarning(lcNetwork) << "Ignoring request to capture network traffic while replaying it";
+        return false;
+    }
+
+    captureStartTime_ = clock_.nsecsElapsed() / 1000;
+    if (!capture_.open(path)) {
+        return false;
+    }
+
+    // Request URLs are recorded as-is, which includes the Hue and Nanoleaf credentials.
+    qCInfo(lcNetwork) << "Capturing network traffic, which includes device credentials, to: " << path;
+    return true;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+bool NetworkInterface::startReplay(const QString& path, const double speed) {
+    QVector<NetworkCapture::Exchange> exchanges;
+    QVector<NetworkCapture::ZeroConfResult> zeroConfResults;
+    if (!NetworkCapture::read(path, exchanges, zeroConfResults)) {
+        return false;
+    }
+
+    // Swap in the replay backend, nothing goes out on the network from here on.
+    manager_->deleteLater();
+    replayManager_ = new ReplayNetworkAccessManager(exchanges, speed, this);
+    manager_ = replayManager_;
+    connect(manager_, &QNetworkAccessManager::finished, this, &NetworkInterface::handleReply);
+    replayZeroConfResults_ = zeroConfResults;
+
+    if (speed > 0.0) {
+        qCInfo(lcNetwork) << "Replaying network traffic at " << speed << "x speed from: " << path;
+    } else {
+        qCInfo(lcNetwork) << "Replaying network traffic as fast as possible from: " << path;
+    }
+    return true;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
 void NetworkInterface::handleReply(QNetworkReply* reply) {
+    if (!pendingRequests_.contains(reply)) {
+        // Replies to preconnects only say that a connection is ready.
+        if (reply->error() != QNetworkReply::NoError) {
+            qCDebug(lcNetwork) << "Failed to preconnect to " << reply->url().host() << ": " << reply->errorString();
+        }
+        reply->deleteLater();
+        return;
+    }
+
     int statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
-    QObject* sender = reply->request().originatingObject();
     QByteArray body = reply->readAll();
 
+    // Everyone still waiting on the reply gets it, or it goes out once without a sender if nobody said who they were.
+    PendingRequest pending = pendingRequests_.take(reply);
+    if (!pending.sharingKey.isEmpty()) {
+        (void)sharedReplies_.remove(pending.sharingKey);
+    }
+    updateInFlightCount(pending.host, -1);
+    QVector<QObject*> senders;
+    for (const auto& pendingSender : qAsConst(pending.senders)) {
+        if (pendingSender) {
+            senders.append(pendingSender.data());
+        }
+    }
+    if (pending.senders.isEmpty()) {
+        senders.append(nullptr);
+    }
+    QObject* sender = senders.isEmpty() ? nullptr : senders.first();
+
+    // Record how the request went, with a status code of 0 meaning that it never got a response.
+    QString host = reply->url().host();
+    QString plugin = sender ? sender->objectName() : QString();
+    qint64 startTime = pending.startTime;
+    qint64 latency = (clock_.nsecsElapsed() / 1000) - startTime;
+    if ((reply->error() == QNetworkReply::OperationCanceledError) && !senders.isEmpty()) {
+        qCDebug(lcNetwork) << "Request timed out: " << reply->url().toDisplayString(QUrl::RemoveQuery);
+        hostMetrics(host).timedOutRequests->increment();
+    }
+
+    // Judge the health of the host by whether it answered, unless the request was cancelled before it could.
+    if (!senders.isEmpty()) {
+        recordOutcome(pending.host, (statusCode != 0) && (statusCode < 500));
+    } else if (circuitState(pending.host) == CircuitState::HalfOpen) {
+        // Nobody took the reply to the probe, so let the next request probe instead.
+        HostHealth& health = hostHealth_[pending.host];
+        health.retryTime = 0;
+        setCircuitState(pending.host, health, CircuitState::Open);
+    }
+    hostMetrics(host).requestDuration->record(latency);
+    responseCounter(host, statusCode)->increment();
+    senderMetrics(host, plugin).responseBytes->increment(static_cast<quint64>(body.size()));
+    if (reply->attribute(QNetworkRequest::Http2WasUsedAttribute).toBool()) {
+        hostMetrics(host).http2Responses->increment();
+    }
+
+    if (capture_.isOpen()) {
+        capture_.record(NetworkCapture::Exchange{(startTime - captureStartTime_) / 1000,
+                                                 latency / 1000,
+                                                 reply->operation(),
+                                                 reply->url(),
+                                                 statusCode,
+                                                 reply->header(QNetworkRequest::ContentTypeHeader).toByteArray(),
+                                                 body});
+    }
+
+    // Time parsing and handling of the reply, which is attributed to whoever sent the request.
+    Profiler::Scope scope("reply", plugin);
+    QElapsedTimer handlingTimer;
+    handlingTimer.start();
+
     // Emit an additional signal if this is JSON content.
     if (reply->header(QNetworkRequest::ContentTypeHeader).toString().startsWith(JSON_CONTENT_TYPE)) {
-        emit jsonReplyReceived(statusCode, sender, QJsonDocument::fromJson(body));
+        QJsonDocument document = QJsonDocument::fromJson(body);
+        for (QObject* recipient : qAsConst(senders)) {
+            emit jsonReplyReceived(statusCode, recipient, document);
+        }
+    }
+
+    for (QObject* recipient : qAsConst(senders)) {
+        emit replyReceived(statusCode, recipient, body);
     }
 
-    emit replyReceived(statusCode, sender, body);
+    replyHandlingDuration(plugin)->record(handlingTimer.nsecsElapsed() / 1000);
+
     reply->deleteLater();
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
 
+void NetworkInterface::handleEncrypted(QNetworkReply* reply) {
+    // A handshake only happens for a new connection, so every one a request waited on is a connection not reused.
+    QString host = reply->url().host();
+    if (reply->url().scheme() == PRECONNECT_SCHEME) {
+        hostMetrics(host).preconnects->increment();
+        return;
+    }
+
+    connectionStats_[host].handshakeCount++;
+    hostMetrics(host).handshakes->increment();
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void NetworkInterface::replayZeroConf(const QString& serviceType) {
+    for (const auto& result : qAsConst(replayZeroConfResults_)) {
+        if (result.serviceType == serviceType) {
+            // Found when it was originally, relative to the start of the capture.
+            QString ipAddress = result.ipAddress;
+            int delay = static_cast<int>(replayManager_->scaled(result.time));
+            QTimer::singleShot(delay, this, [this, serviceType, ipAddress] {
+                emit zeroConfServiceFound(serviceType, ipAddress);
+            });
+            return;
+        }
+    }
+
+    qCWarning(lcNetwork) << "No recorded ZeroConf service to replay: " << serviceType;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+NetworkInterface::HostMetrics& NetworkInterface::hostMetrics(const QString& host) {
+    auto it = hostMetrics_.find(host);
+    if (it != hostMetrics_.end()) {
+        return *it;
+    }
+
+    Metrics* metrics = Metrics::instance();
+    Metrics::Labels labels{{"host", host}};
+    HostMetrics entry{
+        metrics->counter("vc_http_requests_shared_total", "HTTP requests answered by one already in flight.", labels),
+        metrics->counter("vc_http_requests_dropped_total", "HTTP requests dropped with too many in flight.", labels),
+        metrics->counter(
+            "vc_http_requests_suppressed_total", "HTTP requests turned away while the host is down.", labels),
+        metrics->counter("vc_http_requests_cancelled_total",
+                         "HTTP requests cancelled with nobody left to take the reply.",
+                         labels),
+        metrics->counter("vc_http_requests_timed_out_total", "HTTP requests that timed out.", labels),
+        metrics->counter("vc_http2_responses_total", "HTTP replies received over HTTP/2.", labels),
+        metrics->counter("vc_tls_preconnects_total", "TLS connections set up ahead of requests.", labels),
+        metrics->counter("vc_tls_handshakes_total", "TLS handshakes that requests waited on.", labels),
+        metrics->gauge("vc_http_requests_in_flight", "HTTP requests sent without a reply yet.", labels),
+        metrics->gauge("vc_host_circuit_state", "Circuit state of each host: 0 closed, 1 open, 2 half-open.", labels),
+        metrics->histogram(
+            "vc_http_request_duration_seconds", "Time from sending HTTP requests to their replies.", labels),
+        {}};
+    return *hostMetrics_.insert(host, entry);
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+Metrics::Counter* NetworkInterface::responseCounter(const QString& host, const int statusCode) {
+    QHash<int, Metrics::Counter*>& responses = hostMetrics(host).responses;
+    Metrics::Counter* counter = responses.value(statusCode);
+    if (!counter) {
+        counter = Metrics::instance()->counter("vc_http_responses_total",
+                                               "HTTP replies received.",
+                                               {{"host", host}, {"code", QString::number(statusCode)}});
+        responses.insert(statusCode, counter);
+    }
+    return counter;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+const NetworkInterface::SenderMetrics& NetworkInterface::senderMetrics(const QString& host, const QString& plugin) {
+    QPair<QString, QString> key(host, plugin);
+    auto it = senderMetrics_.constFind(key);
+    if (it != senderMetrics_.constEnd()) {
+        return *it;
+    }
+
+    Metrics* metrics = Metrics::instance();
+    Metrics::Labels labels{{"host", host}, {"plugin", plugin}};
+    SenderMetrics entry{
+        metrics->counter("vc_http_requests_total", "HTTP requests sent.", labels),
+        metrics->counter("vc_http_request_bytes_total", "HTTP request body bytes sent.", labels),
+        metrics->counter("vc_http_response_bytes_total", "HTTP reply body bytes received.", labels)};
+    return *senderMetrics_.insert(key, entry);
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+Metrics::Histogram* NetworkInterface::replyHandlingDuration(const QString& plugin) {
+    Metrics::Histogram* histogram = replyHandlingDurations_.value(plugin);
+    if (!histogram) {
+        histogram = Metrics::instance()->histogram(
+            "vc_reply_handling_duration_seconds", "Time spent parsing and handling replies.", {{"plugin", plugin}});
+        replyHandlingDurations_.insert(plugin, histogram);
+    }
+    return histogram;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
 void NetworkInterface::handleZeroConfServiceAdded(QZeroConfService service) {
     if (zeroConfBrowseRequests_.isEmpty() || !service->type().startsWith(zeroConfBrowseRequests_.front())) {
         // Service does not match the next one we were looking for, ignore.
         return;
     }
 
-    emit zeroConfServiceFound(zeroConfBrowseRequests_.dequeue(), service->ip().toString());
+    QString serviceType = zeroConfBrowseRequests_.dequeue();
+    if (capture_.isOpen()) {
+        capture_.record(NetworkCapture::ZeroConfResult{
+            ((clock_.nsecsElapsed() / 1000) - captureStartTime_) / 1000, serviceType, service->ip().toString()});
+    }
+    emit zeroConfServiceFound(serviceType, service->ip().toString());
     zeroConf_->stopBrowser();
 
     // Are there more requests pending?
@@ -160,3 +546,128 @@ void NetworkInterface::handleZeroConfServiceAdded(QZeroConfService service) {
     }
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
+
+QString NetworkInterface::sharingKey(const QUrl& destination, const QByteArray& authorization) {
+    // The authorization is part of it, so a reply is never handed to anyone who could not have asked for it.
+    return destination.toString(QUrl::FullyEncoded) + QLatin1Char('\n') + QString::fromLatin1(authorization);
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void NetworkInterface::addSender(QNetworkReply* reply, QObject* sender) {
+    if (!sender) {
+        return;
+    }
+
+    auto it = pendingRequests_.find(reply);
+    if ((it == pendingRequests_.end()) || it->senders.contains(sender)) {
+        return;
+    }
+    it->senders.append(sender);
+
+    // Give up on the request once nobody is left to take the reply. Tied to the reply, so this goes away with it.
+    connect(sender, &QObject::destroyed, reply, [this, reply] { cancelIfAbandoned(reply); });
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void NetworkInterface::cancelIfAbandoned(QNetworkReply* reply) {
+    auto it = pendingRequests_.constFind(reply);
+    if (it == pendingRequests_.constEnd()) {
+        return;
+    }
+
+    for (const auto& sender : it->senders) {
+        if (sender) {
+            return;
+        }
+    }
+
+    qCDebug(lcNetwork) << "Cancelling request with nobody left to take the reply";
+    hostMetrics(it->host).cancelledRequests->increment();
+    reply->abort();
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void NetworkInterface::updateInFlightCount(const QString& host, const int change) {
+    int count = qMax(0, inFlightCounts_.value(host) + change);
+    if (count > 0) {
+        inFlightCounts_.insert(host, count);
+    } else {
+        (void)inFlightCounts_.remove(host);
+    }
+
+    hostMetrics(host).inFlight->set(count);
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+bool NetworkInterface::allowRequest(const QString& host, const QObject* sender) {
+    HostHealth& health = hostHealth_[host];
+    if (sender) {
+        health.senders.insert(sender->objectName());
+    }
+
+    switch (health.state) {
+        case CircuitState::Closed:
+            return true;
+
+        case CircuitState::Open:
+            if (clock_.elapsed() < health.retryTime) {
+                return false;
+            }
+
+            // Let this one through to see whether the host is back, holding everything else until it is answered.
+            qCDebug(lcNetwork) << "Probing host: " << host;
+            setCircuitState(host, health, CircuitState::HalfOpen);
+            return true;
+
+        case CircuitState::HalfOpen:
+            return false;
+    }
+
+    return true;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void NetworkInterface::recordOutcome(const QString& host, const bool success) {
+    auto it = hostHealth_.find(host);
+    if (it == hostHealth_.end()) {
+        return;
+    }
+
+    if (success) {
+        it->failureCount = 0;
+        it->backoff = 0;
+        if (it->state != CircuitState::Closed) {
+            qCInfo(lcNetwork) << "Host is back: " << host;
+            setCircuitState(host, *it, CircuitState::Closed);
+        }
+        return;
+    }
+
+    it->failureCount++;
+    if (it->state == CircuitState::HalfOpen) {
+        // Still down, so wait longer before the next probe.
+        it->backoff = qMin(it->backoff * 2, MAX_BACKOFF);
+        openCircuit(host, *it);
+    } else if ((it->state == CircuitState::Closed) && (it->failureCount >= FAILURE_THRESHOLD)) {
+        qCWarning(lcNetwork) << "Host is down, holding off requests to: " << host;
+        openCircuit(host, *it);
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void NetworkInterface::openCircuit(const QString& host, HostHealth& health) {
+    health.backoff = qBound(MIN_BACKOFF, health.backoff, MAX_BACKOFF);
+    qCDebug(lcNetwork) << "Probing host again in " << health.backoff << " ms: " << host;
+    health.retryTime = clock_.elapsed() + health.backoff;
+    setCircuitState(host, health, CircuitState::Open);
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void NetworkInterface::setCircuitState(const QString& host, HostHealth& health, const CircuitState state) {
+    if (health.state != state) {
+        health.state = state;
+        hostMetrics(host).circuitState->set(static_cast<int>(state));
+        emit circuitStateChanged(host);
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
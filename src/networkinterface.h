@@ -4,49 +4,172 @@
 #include <QtZeroConf/qzeroconf.h>
 
 #include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
 #include <QJsonDocument>
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QObject>
+#include <QPair>
+#include <QPointer>
 #include <QQueue>
+#include <QSet>
+#include <QSslConfiguration>
 #include <QString>
 #include <QTimer>
+#include <QVector>
 
+#include "metrics.h"
+#include "networkcapture.h"
+
+// Sends requests on behalf of the plugins and hands the replies back to them. Every request gives up after a timeout,
+// is cancelled if its sender goes away first, and an identical GET to one already in flight just waits on that one's
+// reply, so what is outstanding for a host stays bounded however badly it is doing.
+//
+// HTTPS requests offer HTTP/2 and share connections, and known hosts get a connection set up ahead of time so that the
+// first request after an idle stretch does not wait on a TLS handshake.
+//
+// Each host also has a circuit breaker. After a few failures in a row the circuit opens and requests to the host are
+// turned away, until a backoff has passed and one is let through as a probe. The circuit closes again if the probe
+// succeeds, and otherwise stays open for twice as long.
 class NetworkInterface final : public QObject {
     Q_OBJECT
 
+    // clang-format off
+    Q_PROPERTY(int requestTimeout  READ requestTimeout  WRITE setRequestTimeout  NOTIFY requestTimeoutChanged)
+    // clang-format on
+
  public:
+    enum class CircuitState {
+        Closed,    // Healthy, requests go through
+        Open,      // Down, requests are turned away
+        HalfOpen,  // Probing whether it is back
+    };
+    Q_ENUM(CircuitState)
+
     static NetworkInterface* instance();
 
+    // A timeout of 0 uses the request timeout.
     void sendRequest(const QUrl& destination,
                      QObject* sender = nullptr,
                      QNetworkAccessManager::Operation requestType = QNetworkAccessManager::GetOperation,
                      const QByteArray& body = {},
                      const QByteArray& contentType = "text/plain",
-                     const QByteArray& authorization = {});
+                     const QByteArray& authorization = {},
+                     int timeout = 0);
     void sendJSONRequest(const QUrl& destination,
                          QObject* sender = nullptr,
                          QNetworkAccessManager::Operation requestType = QNetworkAccessManager::GetOperation,
                          const QJsonDocument& body = {},
-                         const QByteArray& authorization = {});
+                         const QByteArray& authorization = {},
+                         int timeout = 0);
     void browseZeroConf(const QString& serviceType);
 
+    bool startCapture(const QString& path);
+    bool startReplay(const QString& path, double speed);
+
+    int requestTimeout() const { return requestTimeout_; }  // Milliseconds
+    void setRequestTimeout(int value);
+    int outstandingReplyCount() const { return pendingRequests_.size(); }  // Sent without a reply yet
+    int inFlightCount(const QString& host) const { return inFlightCounts_.value(host); }
+    CircuitState circuitState(const QString& host) const;
+    void addKnownHost(const QUrl& url);
+    void preconnect();
+    double connectionReuseRatio(const QString& host) const;  // Share of HTTPS requests that skipped a handshake
+    bool isReachable(const QObject* sender) const;  // Whether every host the sender uses has a closed circuit
+
  signals:
+    void requestTimeoutChanged();
+    void circuitStateChanged(const QString& host);
+
     void replyReceived(int statusCode, QObject* sender, const QByteArray& body);
     void jsonReplyReceived(int statusCode, QObject* sender, const QJsonDocument& body);
     void zeroConfServiceFound(const QString& serviceType, const QString& ipAddress);
 
  private slots:
     void handleReply(QNetworkReply* reply);
+    void handleEncrypted(QNetworkReply* reply);
     void handleZeroConfServiceAdded(QZeroConfService service);
 
  private:
+    struct PendingRequest {
+        qint64 startTime;  // Microseconds on the clock
+        QString host;
+        QString sharingKey;                  // Empty unless identical requests can share the reply
+        QVector<QPointer<QObject>> senders;  // Whoever sent it first, then whoever joined in
+    };
+
+    struct ConnectionStats {
+        quint64 requestCount = 0;  // HTTPS only
+        quint64 handshakeCount = 0;
+    };
+
+    struct HostHealth {
+        CircuitState state = CircuitState::Closed;
+        int failureCount = 0;   // In a row
+        int backoff = 0;        // Milliseconds, none until the circuit first opens
+        qint64 retryTime = 0;   // Milliseconds on the clock
+        QSet<QString> senders;  // Object names of everyone who has sent to the host
+    };
+
+    // Metrics are looked up once for each host and plugin, rather than on every request and reply.
+    struct HostMetrics {
+        Metrics::Counter* sharedRequests;
+        Metrics::Counter* droppedRequests;
+        Metrics::Counter* suppressedRequests;
+        Metrics::Counter* cancelledRequests;
+        Metrics::Counter* timedOutRequests;
+        Metrics::Counter* http2Responses;
+        Metrics::Counter* preconnects;
+        Metrics::Counter* handshakes;
+        Metrics::Gauge* inFlight;
+        Metrics::Gauge* circuitState;
+        Metrics::Histogram* requestDuration;
+        QHash<int, Metrics::Counter*> responses;  // Key: status code
+    };
+
+    struct SenderMetrics {
+        Metrics::Counter* requests;
+        Metrics::Counter* requestBytes;
+        Metrics::Counter* responseBytes;
+    };
+
     explicit NetworkInterface(QObject* parent = nullptr);
 
     QNetworkAccessManager* manager_;
     QZeroConf* zeroConf_;
     QQueue<QString> zeroConfBrowseRequests_;
     QTimer zeroConfBrowseTimer_;
+    QElapsedTimer clock_;
+    int requestTimeout_;
+    QHash<QNetworkReply*, PendingRequest> pendingRequests_;
+    QHash<QString, QNetworkReply*> sharedReplies_;  // Key: sharing key
+    QHash<QString, int> inFlightCounts_;            // Key: host
+    QHash<QString, HostHealth> hostHealth_;         // Key: host
+    QSslConfiguration sslConfiguration_;
+    QSet<QString> knownHosts_;
+    QHash<QString, ConnectionStats> connectionStats_;              // Key: host
+    QHash<QString, HostMetrics> hostMetrics_;                      // Key: host
+    QHash<QPair<QString, QString>, SenderMetrics> senderMetrics_;  // Key: host, plugin
+    QHash<QString, Metrics::Histogram*> replyHandlingDurations_;   // Key: plugin
+    NetworkCapture capture_;
+    qint64 captureStartTime_;  // Microseconds on the clock
+    ReplayNetworkAccessManager* replayManager_;  // Only when replaying
+    QVector<NetworkCapture::ZeroConfResult> replayZeroConfResults_;
+
+    void replayZeroConf(const QString& serviceType);
+    HostMetrics& hostMetrics(const QString& host);
+    Metrics::Counter* responseCounter(const QString& host, int statusCode);
+    const SenderMetrics& senderMetrics(const QString& host, const QString& plugin);
+    Metrics::Histogram* replyHandlingDuration(const QString& plugin);
+    static QString sharingKey(const QUrl& destination, const QByteArray& authorization);
+    void addSender(QNetworkReply* reply, QObject* sender);
+    void cancelIfAbandoned(QNetworkReply* reply);
+    void updateInFlightCount(const QString& host, int change);
+    bool allowRequest(const QString& host, const QObject* sender);
+    void recordOutcome(const QString& host, bool success);
+    void openCircuit(const QString& host, HostHealth& health);
+    void setCircuitState(const QString& host, HostHealth& health, CircuitState state);
 
     Q_DISABLE_COPY_MOVE(NetworkInterface)
 };
@@ -0,0 +1,76 @@
+#include "numberformatter.h"
+
+#include <cstring>
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+namespace {
+NumberFormatter* instance_ = nullptr;
+constexpr int MAX_CACHE_SIZE = 64;
+
+template <typename Key, typename Formatter>
+QString lookup(QHash<Key, QString>& cache, const Key& key, quint64& formatCount, Formatter format) {
+    auto it = cache.constFind(key);
+    if (it != cache.constEnd()) {
+        return it.value();
+    }
+
+    // The values on screen change slowly, so rather than tracking what is least recently used just start over when
+    // the cache fills up.
+    if (cache.size() >= MAX_CACHE_SIZE) {
+        cache.clear();
+    }
+
+    formatCount++;
+    QString formatted = format();
+    cache.insert(key, formatted);
+    return formatted;
+}
+}  // namespace
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+NumberFormatter::NumberFormatter(QObject* parent)
+    : QObject(parent), locale_(QLocale::system()), requestCount_(0), formatCount_(0) {
+    // Nothing else to do.
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+NumberFormatter* NumberFormatter::instance() {
+    if (!instance_) {
+        instance_ = new NumberFormatter();
+    }
+
+    return instance_;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+QString NumberFormatter::integer(const int value) {
+    requestCount_++;
+    return lookup(integerCache_, value, formatCount_, [this, value] { return locale_.toString(value); });
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+QString NumberFormatter::decimal(const double value, const int precision) {
+    requestCount_++;
+    return lookup(decimalCache_, decimalKey(value, precision), formatCount_, [this, value, precision] {
+        return locale_.toString(value, 'f', precision);
+    });
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+QString NumberFormatter::percentage(const double value, const bool wholeNumber) {
+    requestCount_++;
+    int precision = wholeNumber ? 0 : 1;
+    return lookup(percentageCache_, decimalKey(value, precision), formatCount_, [this, value, precision] {
+        return locale_.toString(value, 'f', precision).append('%');
+    });
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+NumberFormatter::DecimalKey NumberFormatter::decimalKey(const double value, const int precision) {
+    // Key on the exact value rather than comparing floating point numbers.
+    quint64 bits = 0;
+    static_assert(sizeof(bits) == sizeof(value), "Unexpected size of double");
+    std::memcpy(&bits, &value, sizeof(bits));
+    return {bits, precision};
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,43 @@
+#ifndef NUMBERFORMATTER_H_
+#define NUMBERFORMATTER_H_
+
+#include <QHash>
+#include <QLocale>
+#include <QObject>
+#include <QPair>
+#include <QString>
+
+// Formats numbers for display with the system locale. The locale is looked up once and recently formatted values are
+// remembered, since the same handful of counters get formatted over and over.
+class NumberFormatter final : public QObject {
+    Q_OBJECT
+
+ public:
+    static NumberFormatter* instance();
+
+    QString integer(int value);
+    QString decimal(double value, int precision = 1);
+    QString percentage(double value, bool wholeNumber = false);
+
+    quint64 requestCount() const { return requestCount_; }
+    quint64 formatCount() const { return formatCount_; }  // Requests which were not already cached
+    int cacheSize() const { return integerCache_.size() + decimalCache_.size() + percentageCache_.size(); }
+
+ private:
+    using DecimalKey = QPair<quint64, int>;  // Bits of the value, precision
+
+    explicit NumberFormatter(QObject* parent = nullptr);
+
+    QLocale locale_;
+    QHash<int, QString> integerCache_;
+    QHash<DecimalKey, QString> decimalCache_;
+    QHash<DecimalKey, QString> percentageCache_;
+    quint64 requestCount_;
+    quint64 formatCount_;
+
+    static DecimalKey decimalKey(double value, int precision);
+
+    Q_DISABLE_COPY_MOVE(NumberFormatter)
+};
+
+#endif  // NUMBERFORMATTER_H_
@@ -0,0 +1,44 @@
+#include "pluginviewer.h"
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+PluginViewer::PluginViewer(QObject* parent) : QObject(parent), isActive_(false) {}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+PluginViewer::~PluginViewer() {
+    detach();
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void PluginViewer::setPlugin(VCPlugin* value) {
+    if (plugin_ != value) {
+        detach();
+        plugin_ = value;
+        attach();
+        emit pluginChanged();
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void PluginViewer::setActive(const bool value) {
+    if (isActive_ != value) {
+        detach();
+        isActive_ = value;
+        attach();
+        emit activeChanged();
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void PluginViewer::attach() {
+    if (plugin_ && isActive_) {
+        plugin_->addViewer(this);
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void PluginViewer::detach() {
+    if (plugin_) {
+        plugin_->removeViewer(this);
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,42 @@
+#ifndef PLUGINVIEWER_H_
+#define PLUGINVIEWER_H_
+
+#include <QObject>
+#include <QPointer>
+
+#include "vcplugin.h"
+
+// Lets QML tell a plugin that its data is on screen. A view declares one of these bound to its own visibility, and the
+// plugin keeps refreshing at its full rate for as long as any of them are active.
+class PluginViewer final : public QObject {
+    Q_OBJECT
+
+    // clang-format off
+    Q_PROPERTY(VCPlugin * plugin  READ plugin    WRITE setPlugin  NOTIFY pluginChanged)
+    Q_PROPERTY(bool active        READ isActive  WRITE setActive  NOTIFY activeChanged)
+    // clang-format on
+
+ public:
+    explicit PluginViewer(QObject* parent = nullptr);
+    ~PluginViewer() override;
+
+    VCPlugin* plugin() const { return plugin_; }
+    void setPlugin(VCPlugin* value);
+    bool isActive() const { return isActive_; }
+    void setActive(bool value);
+
+ signals:
+    void pluginChanged();
+    void activeChanged();
+
+ private:
+    QPointer<VCPlugin> plugin_;
+    bool isActive_;
+
+    void attach();
+    void detach();
+
+    Q_DISABLE_COPY_MOVE(PluginViewer)
+};
+
+#endif  // PLUGINVIEWER_H_
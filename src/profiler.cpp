@@ -0,0 +1,364 @@
+#include "profiler.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QStandardPaths>
+
+#include "logging.h"
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+namespace {
+Profiler* instance_ = nullptr;
+constexpr int MAX_EVENTS = 100000;
+constexpr int HEARTBEAT_INTERVAL = 50;      // Milliseconds
+constexpr int WATCHDOG_INTERVAL = 20;       // Milliseconds
+constexpr qint64 STALL_THRESHOLD = 100000;  // Microseconds
+constexpr int PUBLISH_INTERVAL = 1000;      // Milliseconds
+}  // namespace
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+Profiler::Scope::Scope(const char* category, const QString& name)
+    : isRecording_(instance_ && instance_->isEnabled_) {
+    if (isRecording_) {
+        instance_->beginScope(category, name);
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+Profiler::Scope::Scope(const char* category, const QString& name, const int step)
+    : isRecording_(instance_ && instance_->isEnabled_) {
+    if (isRecording_) {
+        instance_->beginScope(category, QString("%1 step %2").arg(name).arg(step));
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+Profiler::Scope::~Scope() {
+    if (isRecording_) {
+        instance_->endScope();
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+Profiler::Profiler(QObject* parent)
+    : QObject(parent),
+      isEnabled_(false),
+      isOverlayVisible_(false),
+      frameRate_(0.0),
+      syncTime_(0.0),
+      renderTime_(0.0),
+      worstFrameTime_(0.0),
+      stallCount_(0),
+      watchdog_(nullptr),
+      nextEvent_(0),
+      lastBeat_(0),
+      frameStatistics_{0, 0, 0, 0, 0},
+      syncStart_(0),
+      renderStart_(0) {
+    setObjectName("Profiler");
+    clock_.start();
+
+    // The heartbeat is what the watchdog thread watches for, it can only run when the event loop gets to it.
+    heartbeatTimer_.setInterval(HEARTBEAT_INTERVAL);
+    heartbeatTimer_.setSingleShot(false);
+    heartbeatTimer_.setTimerType(Qt::PreciseTimer);
+    connect(&heartbeatTimer_, &QTimer::timeout, this, &Profiler::beat);
+
+    publishTimer_.setInterval(PUBLISH_INTERVAL);
+    publishTimer_.setSingleShot(false);
+    connect(&publishTimer_, &QTimer::timeout, this, &Profiler::publishStatistics);
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+Profiler::~Profiler() {
+    stopWatchdog();
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+Profiler* Profiler::instance() {
+    if (!instance_) {
+        instance_ = new Profiler();
+    }
+
+    return instance_;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void Profiler::attach(QQuickWindow* window) {
+    if (!window) {
+        qCWarning(lcProfiler) << "Not profiling frames without a window";
+        return;
+    }
+
+    // With the threaded render loop these are emitted on the render thread, so they have to be handled there
+    // directly rather than queued behind whatever is holding up the GUI thread.
+    connect(
+        window,
+        &QQuickWindow::beforeSynchronizing,
+        this,
+        [this] { syncStart_ = now(); },
+        Qt::DirectConnection);
+    connect(
+        window,
+        &QQuickWindow::afterSynchronizing,
+        this,
+        [this] {
+            if (isRecording_.loadAcquire()) {
+                qint64 duration = now() - syncStart_;
+                record("frame", "Sync", RenderThread, syncStart_, duration);
+
+                QMutexLocker locker(&mutex_);
+                frameStatistics_.syncTotal += duration;
+            }
+        },
+        Qt::DirectConnection);
+    connect(
+        window,
+        &QQuickWindow::beforeRendering,
+        this,
+        [this] { renderStart_ = now(); },
+        Qt::DirectConnection);
+    connect(
+        window,
+        &QQuickWindow::afterRendering,
+        this,
+        [this] {
+            if (isRecording_.loadAcquire()) {
+                qint64 duration = now() - renderStart_;
+                record("frame", "Render", RenderThread, renderStart_, duration);
+
+                QMutexLocker locker(&mutex_);
+                frameStatistics_.renderTotal += duration;
+            }
+        },
+        Qt::DirectConnection);
+    connect(
+        window,
+        &QQuickWindow::frameSwapped,
+        this,
+        [this] {
+            if (isRecording_.loadAcquire()) {
+                // A frame runs from the start of synchronizing through the swap, idle time in between is not counted.
+                qint64 duration = now() - syncStart_;
+                record("frame", "Frame", RenderThread, syncStart_, duration);
+
+                QMutexLocker locker(&mutex_);
+                frameStatistics_.frameCount++;
+                frameStatistics_.worstFrame = qMax(frameStatistics_.worstFrame, duration);
+            }
+        },
+        Qt::DirectConnection);
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void Profiler::setEnabled(const bool value) {
+    if (isEnabled_ != value) {
+        isEnabled_ = value;
+        emit enabledChanged();
+
+        if (isEnabled_) {
+            {
+                QMutexLocker locker(&mutex_);
+                events_.clear();
+                nextEvent_ = 0;
+                activeScopes_.clear();
+                activeScopeStarts_.clear();
+                lastBeat_ = now();
+                frameStatistics_ = FrameStatistics{0, 0, 0, 0, lastBeat_};
+            }
+            isRecording_.storeRelease(1);
+            heartbeatTimer_.start();
+            publishTimer_.start();
+            startWatchdog();
+            qCInfo(lcProfiler) << "Started profiling";
+        } else {
+            stopWatchdog();
+            heartbeatTimer_.stop();
+            publishTimer_.stop();
+            isRecording_.storeRelease(0);
+            qCInfo(lcProfiler) << "Stopped profiling";
+        }
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void Profiler::setOverlayVisible(const bool value) {
+    if (isOverlayVisible_ != value) {
+        isOverlayVisible_ = value;
+        emit overlayVisibleChanged();
+
+        // There is nothing to show without recording.
+        if (isOverlayVisible_) {
+            setEnabled(true);
+        }
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+QString Profiler::dumpTrace() {
+    QJsonArray traceEvents;
+    const QVector<QPair<int, QString>> threadNames{
+        {GuiThread, "GUI"}, {RenderThread, "Render"}, {WatchdogThread, "Stalls"}};
+    for (const auto& threadName : threadNames) {
+        traceEvents.append(QJsonObject{{"name", "thread_name"},
+                                       {"ph", "M"},
+                                       {"pid", 1},
+                                       {"tid", threadName.first},
+                                       {"args", QJsonObject{{"name", threadName.second}}}});
+    }
+
+    {
+        // Walk the ring buffer from the oldest event.
+        QMutexLocker locker(&mutex_);
+        int count = events_.size();
+        int first = (count < MAX_EVENTS) ? 0 : nextEvent_;
+        for (int i = 0; i < count; i++) {
+            const Event& event = events_.at((first + i) % count);
+            traceEvents.append(QJsonObject{{"name", QString::fromUtf8(event.name)},
+                                           {"cat", QString::fromUtf8(event.category)},
+                                           {"ph", "X"},
+                                           {"pid", 1},
+                                           {"tid", event.thread},
+                                           {"ts", event.start},
+                                           {"dur", event.duration}});
+        }
+    }
+
+    QString filename =
+        QString("VC Trace %1.json").arg(QDateTime::currentDateTime().toString("yyyy-MM-dd hh.mm.ss"));
+    QString path = QDir(QStandardPaths::writableLocation(QStandardPaths::DesktopLocation)).absoluteFilePath(filename);
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(lcProfiler) << "Failed to open trace file: " << path;
+        return QString();
+    }
+    file.write(QJsonDocument(QJsonObject{{"traceEvents", traceEvents}, {"displayTimeUnit", "ms"}})
+                   .toJson(QJsonDocument::Compact));
+    qCInfo(lcProfiler) << "Saved trace with " << (traceEvents.size() - threadNames.size()) << " events: " << path;
+    return path;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void Profiler::beat() {
+    QMutexLocker locker(&mutex_);
+    lastBeat_ = now();
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void Profiler::publishStatistics() {
+    {
+        QMutexLocker locker(&mutex_);
+        qint64 current = now();
+        const FrameStatistics& statistics = frameStatistics_;
+        double windowSeconds = qMax(current - statistics.windowStart, qint64(1)) / 1e6;
+        frameRate_ = statistics.frameCount / windowSeconds;
+        syncTime_ = statistics.frameCount ? (statistics.syncTotal / 1e3) / statistics.frameCount : 0.0;
+        renderTime_ = statistics.frameCount ? (statistics.renderTotal / 1e3) / statistics.frameCount : 0.0;
+        worstFrameTime_ = statistics.worstFrame / 1e3;
+        frameStatistics_ = FrameStatistics{0, 0, 0, 0, current};
+
+        if (!pendingLastStall_.isEmpty()) {
+            lastStall_ = pendingLastStall_;
+            pendingLastStall_.clear();
+        }
+    }
+    stallCount_ += pendingStallCount_.fetchAndStoreRelaxed(0);
+
+    emit statisticsChanged();
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void Profiler::record(
+    const QByteArray& category, const QByteArray& name, const int thread, const qint64 start, const qint64 duration) {
+    QMutexLocker locker(&mutex_);
+    Event event{category, name, thread, start, duration};
+    if (events_.size() < MAX_EVENTS) {
+        events_.append(event);
+    } else {
+        events_[nextEvent_] = event;
+    }
+    nextEvent_ = (nextEvent_ + 1) % MAX_EVENTS;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void Profiler::beginScope(const char* category, const QString& name) {
+    QMutexLocker locker(&mutex_);
+    activeScopes_.append(qMakePair(QByteArray(category), name.toUtf8()));
+    activeScopeStarts_.append(now());
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void Profiler::endScope() {
+    QPair<QByteArray, QByteArray> scope;
+    qint64 start = 0;
+    {
+        QMutexLocker locker(&mutex_);
+        if (activeScopes_.isEmpty()) {
+            // Profiling was restarted part way through the scope.
+            return;
+        }
+        scope = activeScopes_.takeLast();
+        start = activeScopeStarts_.takeLast();
+    }
+    record(scope.first, scope.second, GuiThread, start, now() - start);
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void Profiler::watch() {
+    qint64 stallStart = -1;
+    QByteArray cause;
+    while (isWatching_.loadAcquire()) {
+        QThread::msleep(WATCHDOG_INTERVAL);
+
+        QMutexLocker locker(&mutex_);
+        qint64 expectedBeat = lastBeat_ + (HEARTBEAT_INTERVAL * 1000);
+        if (stallStart < 0) {
+            if ((now() - expectedBeat) >= STALL_THRESHOLD) {
+                // The event loop is blocked, blame whatever it was last seen running.
+                stallStart = expectedBeat;
+                if (activeScopes_.isEmpty()) {
+                    cause = "Unattributed";
+                } else {
+                    cause = activeScopes_.last().first + ": " + activeScopes_.last().second;
+                }
+            }
+        } else if (lastBeat_ >= stallStart) {
+            // The event loop got going again.
+            qint64 duration = lastBeat_ - stallStart;
+            locker.unlock();
+            record("stall", cause, WatchdogThread, stallStart, duration);
+            locker.relock();
+
+            pendingLastStall_ = QString("%1 (%2 ms)").arg(QString::fromUtf8(cause)).arg(duration / 1000);
+            pendingStallCount_.ref();
+            qCWarning(lcProfiler) << "Detected GUI stall of " << (duration / 1000) << " ms in: " << cause;
+            stallStart = -1;
+        }
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void Profiler::startWatchdog() {
+    if (!watchdog_) {
+        isWatching_.storeRelease(1);
+        watchdog_ = QThread::create([this] { watch(); });
+        watchdog_->setObjectName("ProfilerWatchdog");
+        watchdog_->start(QThread::HighPriority);
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void Profiler::stopWatchdog() {
+    if (watchdog_) {
+        isWatching_.storeRelease(0);
+        watchdog_->wait();
+        delete watchdog_;
+        watchdog_ = nullptr;
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,142 @@
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QObject>
+#include <QPair>
+#include <QQuickWindow>
+#include <QString>
+#include <QThread>
+#include <QTimer>
+#include <QVector>
+
+// Records frame timing from the scene graph and stalls of the GUI thread event loop, attributing each stall to
+// whatever work was running at the time. The recording can be shown as an overlay or dumped as a Chrome trace, which
+// Perfetto and chrome://tracing can open.
+class Profiler final : public QObject {
+    Q_OBJECT
+
+    // clang-format off
+    Q_PROPERTY(bool enabled          READ isEnabled         WRITE setEnabled         NOTIFY enabledChanged)
+    Q_PROPERTY(bool overlayVisible   READ isOverlayVisible  WRITE setOverlayVisible  NOTIFY overlayVisibleChanged)
+    Q_PROPERTY(double frameRate      READ frameRate                                  NOTIFY statisticsChanged)
+    Q_PROPERTY(double syncTime       READ syncTime                                   NOTIFY statisticsChanged)
+    Q_PROPERTY(double renderTime     READ renderTime                                 NOTIFY statisticsChanged)
+    Q_PROPERTY(double worstFrameTime READ worstFrameTime                             NOTIFY statisticsChanged)
+    Q_PROPERTY(int stallCount        READ stallCount                                 NOTIFY statisticsChanged)
+    Q_PROPERTY(QString lastStall     READ lastStall                                  NOTIFY statisticsChanged)
+    // clang-format on
+
+ public:
+    // Marks a stretch of GUI thread work, so any stall during it is attributed to it and it shows up in the trace.
+    // This does nothing beyond a flag check while the profiler is disabled, as long as the name is not built up for it.
+    class Scope {
+     public:
+        Scope(const char* category, const QString& name);
+        Scope(const char* category, const QString& name, int step);  // Named for the step, only when recording
+        ~Scope();
+
+     private:
+        bool isRecording_;
+
+        Q_DISABLE_COPY_MOVE(Scope)
+    };
+
+    ~Profiler() override;
+
+    static Profiler* instance();
+
+    void attach(QQuickWindow* window);
+
+    bool isEnabled() const { return isEnabled_; }
+    void setEnabled(bool value);
+    bool isOverlayVisible() const { return isOverlayVisible_; }
+    void setOverlayVisible(bool value);
+    double frameRate() const { return frameRate_; }            // Frames per second
+    double syncTime() const { return syncTime_; }              // Milliseconds, average
+    double renderTime() const { return renderTime_; }          // Milliseconds, average
+    double worstFrameTime() const { return worstFrameTime_; }  // Milliseconds
+    int stallCount() const { return stallCount_; }
+    const QString& lastStall() const { return lastStall_; }
+
+    Q_INVOKABLE QString dumpTrace();
+
+ signals:
+    void enabledChanged();
+    void overlayVisibleChanged();
+    void statisticsChanged();
+
+ private slots:
+    void beat();
+    void publishStatistics();
+
+ private:
+    enum Thread {
+        GuiThread = 1,
+        RenderThread,
+        WatchdogThread,
+    };
+
+    struct Event {
+        QByteArray category;
+        QByteArray name;
+        int thread;
+        qint64 start;     // Microseconds
+        qint64 duration;  // Microseconds
+    };
+
+    struct FrameStatistics {
+        int frameCount;
+        qint64 syncTotal;    // Microseconds
+        qint64 renderTotal;  // Microseconds
+        qint64 worstFrame;   // Microseconds
+        qint64 windowStart;  // Microseconds
+    };
+
+    explicit Profiler(QObject* parent = nullptr);
+
+    bool isEnabled_;
+    bool isOverlayVisible_;
+    double frameRate_;
+    double syncTime_;
+    double renderTime_;
+    double worstFrameTime_;
+    int stallCount_;
+    QString lastStall_;
+    QElapsedTimer clock_;
+    QTimer heartbeatTimer_;
+    QTimer publishTimer_;
+    QThread* watchdog_;
+
+    // Shared between threads.
+    QAtomicInt isRecording_;
+    QAtomicInt isWatching_;
+    QAtomicInt pendingStallCount_;
+    QMutex mutex_;                                         // Guards everything below
+    QVector<Event> events_;                                // Ring buffer
+    int nextEvent_;
+    QVector<QPair<QByteArray, QByteArray>> activeScopes_;  // Category, name
+    QVector<qint64> activeScopeStarts_;                    // Microseconds
+    qint64 lastBeat_;                                      // Microseconds
+    QString pendingLastStall_;
+    FrameStatistics frameStatistics_;
+
+    // Only touched by the render thread.
+    qint64 syncStart_;
+    qint64 renderStart_;
+
+    qint64 now() const { return clock_.nsecsElapsed() / 1000; }
+    void record(const QByteArray& category, const QByteArray& name, int thread, qint64 start, qint64 duration);
+    void beginScope(const char* category, const QString& name);
+    void endScope();
+    void watch();
+    void startWatchdog();
+    void stopWatchdog();
+
+    Q_DISABLE_COPY_MOVE(Profiler)
+};
+
+#endif  // PROFILER_H_
@@ -0,0 +1,215 @@
+#include "scriptdriver.h"
+
+#include <QFile>
+#include <QJsonDocument>
+#include <QMetaMethod>
+#include <QMetaProperty>
+#include <QVariant>
+#include <QVector>
+
+#include "logging.h"
+#include "metrics.h"
+#include "vchub.h"
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+namespace {
+constexpr int DEFAULT_INTERVAL = 1000;  // Milliseconds
+}  // namespace
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+ScriptDriver::ScriptDriver(QObject* parent)
+    : QObject(parent), interval_(DEFAULT_INTERVAL), duration_(0), nextAction_(0) {
+    setObjectName("Driver");
+
+    // View plugins through the tabs the script switches between, starting from the home tab like the dashboard.
+    for (VCPlugin* plugin : VCHub::instance()->plugins()) {
+        PluginViewer* viewer = new PluginViewer(this);
+        viewer->setPlugin(plugin);
+        viewers_.append(viewer);
+    }
+
+    stepTimer_.setSingleShot(false);
+    connect(&stepTimer_, &QTimer::timeout, this, &ScriptDriver::step);
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+bool ScriptDriver::load(const QString& path) {
+    QFile scriptFile(path);
+    if (!scriptFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qCWarning(lcDriver) << "Failed to open script file: " << path;
+        return false;
+    }
+
+    QJsonDocument scriptDocument = QJsonDocument::fromJson(scriptFile.readAll());
+    QJsonObject script = scriptDocument.object();
+    if (!scriptDocument.isObject() || !script.value("actions").isArray()) {
+        qCWarning(lcDriver) << "Failed to parse script file structure: " << path;
+        return false;
+    }
+
+    actions_ = script.value("actions").toArray();
+    interval_ = script.value("interval").toInt(DEFAULT_INTERVAL);
+    duration_ = static_cast<qint64>(script.value("duration").toDouble(0.0) * 1000.0);
+    qCInfo(lcDriver) << "Loaded " << actions_.size() << " actions from script file: " << path;
+    return true;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void ScriptDriver::start(const int interval) {
+    if (interval > 0) {
+        interval_ = interval;
+    }
+
+    qCInfo(lcDriver) << "Performing an action every " << interval_ << " ms";
+    (void)showTab("home");
+    runTimer_.start();
+    stepTimer_.start(qMax(1, interval_));
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void ScriptDriver::step() {
+    if ((duration_ > 0) && runTimer_.hasExpired(duration_)) {
+        qCInfo(lcDriver) << "Finished after " << (runTimer_.elapsed() / 1000) << " s";
+        stepTimer_.stop();
+        emit finished();
+        return;
+    }
+    if (actions_.isEmpty()) {
+        return;
+    }
+
+    QJsonObject action = actions_.at(nextAction_).toObject();
+    nextAction_ = (nextAction_ + 1) % actions_.size();
+    if (!perform(action)) {
+        qCWarning(lcDriver) << "Failed to perform action: "
+                            << QJsonDocument(action).toJson(QJsonDocument::Compact).constData();
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+bool ScriptDriver::perform(const QJsonObject& action) {
+    QString kind;
+    bool success = false;
+    if (action.contains("tab")) {
+        kind = "tab";
+        success = showTab(action.value("tab").toString());
+    } else if (action.contains("invoke")) {
+        kind = "invoke";
+        success = invoke(action.value("invoke").toString(), action.value("arguments").toArray());
+    } else if (action.contains("set")) {
+        kind = "set";
+        success = set(action.value("set").toString(), action.value("value"));
+    } else {
+        return false;
+    }
+
+    Metrics::instance()
+        ->counter("vc_driver_actions_total",
+                  "Actions performed by the script driver.",
+                  {{"action", kind}, {"result", success ? "ok" : "failed"}})
+        ->increment();
+    return success;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+bool ScriptDriver::showTab(const QString& tab) {
+    // The plugins each tab of the dashboard shows something from.
+    VCHub* hub = VCHub::instance();
+    QList<VCPlugin*> shown;
+    if (tab == "home") {
+        shown = hub->plugins();
+    } else if (tab == "lights") {
+        shown = {hub->hue(), hub->nanoleaf()};
+    } else if (tab == "music") {
+        shown = {hub->spotify()};
+    } else if (tab == "network") {
+        shown = {hub->piHole()};
+    } else if (tab != "system") {
+        return false;
+    }
+
+    qCDebug(lcDriver) << "Showing tab: " << tab;
+    for (PluginViewer* viewer : qAsConst(viewers_)) {
+        viewer->setActive(shown.contains(viewer->plugin()));
+    }
+    return true;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+bool ScriptDriver::invoke(const QString& target, const QJsonArray& arguments) {
+    QString methodName;
+    QObject* object = resolve(target, methodName);
+    if (!object || (arguments.size() > MAX_ARGUMENTS)) {
+        return false;
+    }
+
+    // Find an invokable method by that name taking as many arguments as were given, which picks between the overloads
+    // generated for default arguments too.
+    const QMetaObject* metaObject = object->metaObject();
+    for (int i = 0; i < metaObject->methodCount(); i++) {
+        QMetaMethod method = metaObject->method(i);
+        if ((method.name() != methodName.toLatin1()) || (method.parameterCount() != arguments.size()) ||
+            (method.access() != QMetaMethod::Public)) {
+            continue;
+        }
+
+        // Move on to the next overload when the arguments do not fit this one.
+        QVector<QVariant> values;
+        values.reserve(arguments.size());
+        for (int j = 0; j < arguments.size(); j++) {
+            QVariant value = arguments.at(j).toVariant();
+            if (!value.convert(method.parameterType(j))) {
+                break;
+            }
+            values.append(value);
+        }
+        if (values.size() != arguments.size()) {
+            continue;
+        }
+
+        QList<QByteArray> parameterTypes = method.parameterTypes();
+        QGenericArgument genericArguments[MAX_ARGUMENTS];
+        for (int j = 0; j < values.size(); j++) {
+            genericArguments[j] = QGenericArgument(parameterTypes.at(j).constData(), values.at(j).constData());
+        }
+
+        qCDebug(lcDriver) << "Invoking: " << target;
+        return method.invoke(object,
+                             Qt::DirectConnection,
+                             genericArguments[0],
+                             genericArguments[1],
+                             genericArguments[2],
+                             genericArguments[3]);
+    }
+
+    return false;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+bool ScriptDriver::set(const QString& target, const QJsonValue& value) {
+    QString propertyName;
+    QObject* object = resolve(target, propertyName);
+    if (!object || (object->metaObject()->indexOfProperty(qPrintable(propertyName)) < 0)) {
+        return false;
+    }
+
+    qCDebug(lcDriver) << "Setting: " << target;
+    return object->setProperty(qPrintable(propertyName), value.toVariant());
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+QObject* ScriptDriver::resolve(const QString& target, QString& member) {
+    // Targets name an object and one of its members, just like config keys.
+    QStringList parts = target.split('.');
+    if (parts.size() != 2) {
+        return nullptr;
+    }
+    member = parts.takeLast();
+
+    QObject* object = VCHub::instance();
+    if (object->objectName() != parts.first()) {
+        object = object->findChild<QObject*>(parts.first());
+    }
+    return object;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
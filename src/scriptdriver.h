@@ -0,0 +1,66 @@
+#ifndef SCRIPTDRIVER_H_
+#define SCRIPTDRIVER_H_
+
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+
+#include "pluginviewer.h"
+
+// Stands in for someone using the dashboard, for soak and load testing without a display. A script is a JSON file
+// listing actions that are performed one after another at a steady rate, starting over after the last one:
+//
+//   {
+//       "interval": 5000,
+//       "duration": 86400,
+//       "actions": [
+//           {"tab": "music"},
+//           {"invoke": "Spotify.next"},
+//           {"invoke": "Hub.runScene", "arguments": ["Relax"]},
+//           {"set": "Hub.darkerBackground", "value": true}
+//       ]
+//   }
+//
+// The interval is in milliseconds between actions, and the duration is in seconds until the driver finishes, or 0 to
+// run until stopped. Targets are "Object.member", resolved the same way as config keys. Switching tabs changes which
+// plugins are viewed, just as showing the tab would.
+class ScriptDriver final : public QObject {
+    Q_OBJECT
+
+ public:
+    explicit ScriptDriver(QObject* parent = nullptr);
+
+    bool load(const QString& path);
+    void start(int interval = 0);
+
+ signals:
+    void finished();
+
+ private slots:
+    void step();
+
+ private:
+    static constexpr int MAX_ARGUMENTS = 4;
+
+    QJsonArray actions_;
+    int interval_;     // Milliseconds
+    qint64 duration_;  // Milliseconds, 0 for none
+    int nextAction_;
+    QTimer stepTimer_;
+    QElapsedTimer runTimer_;
+    QList<PluginViewer*> viewers_;
+
+    bool perform(const QJsonObject& action);
+    bool showTab(const QString& tab);
+    bool invoke(const QString& target, const QJsonArray& arguments);
+    bool set(const QString& target, const QJsonValue& value);
+    static QObject* resolve(const QString& target, QString& member);
+
+    Q_DISABLE_COPY_MOVE(ScriptDriver)
+};
+
+#endif  // SCRIPTDRIVER_H_
@@ -0,0 +1,126 @@
+#include "spotifyresults.h"
+
+#include <algorithm>
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+SpotifyResults::SpotifyResults(const QList<QByteArray>& roles, QObject* parent)
+    : QAbstractListModel(parent), requester_(nullptr), isLoading_(false), isRestarting_(false) {
+    renewRequester();
+    for (int i = 0; i < roles.size(); i++) {
+        roleNames_.insert(Qt::UserRole + 1 + i, roles.at(i));
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void SpotifyResults::start(const QUrl& firstPage) {
+    cancel();
+    isLoading_ = true;
+    isRestarting_ = true;
+    emit pageRequested(firstPage);
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void SpotifyResults::cancel() {
+    // Requests are cancelled by the network interface once nothing is left to take their replies.
+    renewRequester();
+    isLoading_ = false;
+    isRestarting_ = false;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void SpotifyResults::clear() {
+    cancel();
+    nextPage_.clear();
+    setItems({});
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void SpotifyResults::addPage(const QVariantList& items, const QUrl& nextPage) {
+    isLoading_ = false;
+
+    if (isRestarting_) {
+        isRestarting_ = false;
+
+        // Leave the list alone if the first page has not changed, so a view scrolled further down stays put.
+        if (!items.isEmpty() && (items_.size() >= items.size()) &&
+            std::equal(items.constBegin(), items.constEnd(), items_.constBegin())) {
+            if (items_.size() == items.size()) {
+                nextPage_ = nextPage;
+            }
+            return;
+        }
+
+        nextPage_ = nextPage;
+        setItems(items);
+        return;
+    }
+
+    nextPage_ = nextPage;
+    if (!items.isEmpty()) {
+        beginInsertRows(QModelIndex(), items_.size(), items_.size() + items.size() - 1);
+        items_.append(items);
+        endInsertRows();
+        emit countChanged();
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void SpotifyResults::stopLoading() {
+    isLoading_ = false;
+    isRestarting_ = false;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int SpotifyResults::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : items_.size();
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+QVariant SpotifyResults::data(const QModelIndex& index, const int role) const {
+    if (!index.isValid() || (index.row() >= items_.size()) || !roleNames_.contains(role)) {
+        return QVariant();
+    }
+
+    return items_.at(index.row()).toMap().value(QString::fromLatin1(roleNames_.value(role)));
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+QHash<int, QByteArray> SpotifyResults::roleNames() const {
+    return roleNames_;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+bool SpotifyResults::canFetchMore(const QModelIndex& parent) const {
+    return !parent.isValid() && !nextPage_.isEmpty() && !isLoading_;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void SpotifyResults::fetchMore(const QModelIndex& parent) {
+    if (canFetchMore(parent)) {
+        isLoading_ = true;
+        emit pageRequested(nextPage_);
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void SpotifyResults::renewRequester() {
+    delete requester_;
+
+    // Go by the name of the owner, so that hosts being down show against it.
+    requester_ = new QObject(this);
+    requester_->setObjectName(parent() ? parent()->objectName() : objectName());
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void SpotifyResults::setItems(const QVariantList& items) {
+    int previousCount = items_.size();
+
+    beginResetModel();
+    items_ = items;
+    endResetModel();
+
+    if (previousCount != items_.size()) {
+        emit countChanged();
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,59 @@
+#ifndef SPOTIFYRESULTS_H_
+#define SPOTIFYRESULTS_H_
+
+#include <QAbstractListModel>
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QUrl>
+#include <QVariant>
+
+// A list filled in a page at a time from a paginated Spotify API, which asks for the next page when a view scrolls
+// near the end. The owner sends the requests it asks for, using the requester as the sender so that replies can be
+// told apart and so that starting over cancels whatever is still on the way.
+class SpotifyResults final : public QAbstractListModel {
+    Q_OBJECT
+
+    // clang-format off
+    Q_PROPERTY(int count  READ count  NOTIFY countChanged)
+    // clang-format on
+
+ public:
+    SpotifyResults(const QList<QByteArray>& roles, QObject* parent = nullptr);
+
+    int count() const { return items_.size(); }
+    QObject* requester() const { return requester_; }  // Sender of the requests for the current query
+
+    // Starts again from the first page, which replaces what is shown when it arrives unless it matches what is already
+    // there, in which case the pages loaded after it are kept too.
+    void start(const QUrl& firstPage);
+    void cancel();
+    void clear();
+    void addPage(const QVariantList& items, const QUrl& nextPage);
+    void stopLoading();  // After a failed request
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+
+ signals:
+    void countChanged();
+    void pageRequested(const QUrl& url);
+
+ private:
+    QHash<int, QByteArray> roleNames_;
+    QVariantList items_;  // Maps keyed by role name
+    QObject* requester_;
+    QUrl nextPage_;
+    bool isLoading_;
+    bool isRestarting_;  // Waiting on the first page
+
+    void renewRequester();
+    void setItems(const QVariantList& items);
+
+    Q_DISABLE_COPY_MOVE(SpotifyResults)
+};
+
+#endif  // SPOTIFYRESULTS_H_
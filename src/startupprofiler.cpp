@@ -0,0 +1,191 @@
+#include "startupprofiler.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QFile>
+#include <QTextStream>
+
+#include "logging.h"
+#include "networkinterface.h"
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+namespace {
+StartupProfiler* instance_ = nullptr;
+constexpr qint64 DEADLINE = 30 * 1000;  // Milliseconds since entering main() to wait for everything
+}  // namespace
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+StartupProfiler::StartupProfiler(QObject* parent)
+    : QObject(parent), isEnabled_(false), isFinished_(false), budget_(0), interactiveTime_(-1) {
+    setObjectName("StartupProfiler");
+    clock_.start();
+    mark("Entered main()");
+
+    deadlineTimer_.setSingleShot(true);
+    connect(&deadlineTimer_, &QTimer::timeout, this, &StartupProfiler::finish);
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+StartupProfiler* StartupProfiler::instance() {
+    if (!instance_) {
+        instance_ = new StartupProfiler();
+    }
+
+    return instance_;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void StartupProfiler::mark(const QString& phase) {
+    if (!isFinished_) {
+        phases_.append(Phase{phase, clock_.elapsed()});
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void StartupProfiler::start(const QString& reportPath, const int budget, const QStringList& plugins) {
+    if (isEnabled_) {
+        return;
+    }
+
+    isEnabled_ = true;
+    reportPath_ = reportPath;
+    budget_ = budget;
+    for (const auto& plugin : plugins) {
+        awaitedReplies_.insert(plugin);
+    }
+
+    // Note the first reply to each plugin, which is when it first has something of its own to show.
+    connect(NetworkInterface::instance(),
+            &NetworkInterface::replyReceived,
+            this,
+            [this](const int statusCode, QObject* const sender, const QByteArray& body) {
+                (void)statusCode;
+                (void)body;
+                if (sender && awaitedReplies_.remove(sender->objectName())) {
+                    mark(QString("First reply to %1").arg(sender->objectName()));
+                    checkFinished();
+                }
+            });
+
+    // Report on whatever happened by the deadline, since some plugins may never hear back.
+    deadlineTimer_.start(static_cast<int>(qMax<qint64>(0, DEADLINE - clock_.elapsed())));
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void StartupProfiler::watch(QQuickWindow* window) {
+    if (!isEnabled_ || !window) {
+        return;
+    }
+
+    window_ = window;
+    QObject* homeTab = window->findChild<QObject*>("homeTab");
+    if (!homeTab) {
+        qCWarning(lcStartup) << "Failed to find the home tab, startup will not become interactive";
+        return;
+    }
+
+    if (homeTab->property("item").value<QObject*>()) {
+        handleHomeTabLoaded();
+    } else {
+        // The loader type is private to Qt Quick, so its signal can only be connected by name.
+        (void)connect(homeTab, SIGNAL(loaded()), this, SLOT(handleHomeTabLoaded()));
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+bool StartupProfiler::isWithinBudget() const {
+    return (budget_ <= 0) || ((interactiveTime_ >= 0) && (interactiveTime_ <= budget_));
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void StartupProfiler::handleHomeTabLoaded() {
+    if (!window_ || frameSwappedConnection_ || (interactiveTime_ >= 0)) {
+        return;
+    }
+    mark("Home tab loaded");
+
+    // The next frame swapped in is the first one with the home tab on it.
+    frameSwappedConnection_ = connect(window_, &QQuickWindow::frameSwapped, this, [this] {
+        disconnect(frameSwappedConnection_);
+        if (interactiveTime_ < 0) {
+            interactiveTime_ = clock_.elapsed();
+            mark("Interactive");
+            checkFinished();
+        }
+    });
+    window_->update();
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void StartupProfiler::checkFinished() {
+    if ((interactiveTime_ >= 0) && awaitedReplies_.isEmpty()) {
+        finish();
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void StartupProfiler::finish() {
+    if (!isEnabled_ || isFinished_) {
+        return;
+    }
+
+    isFinished_ = true;
+    deadlineTimer_.stop();
+
+    QFile file(reportPath_);
+    if (file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        QTextStream stream(&file);
+        stream << report();
+        qCInfo(lcStartup) << "Wrote startup report to: " << reportPath_;
+    } else {
+        qCWarning(lcStartup) << "Failed to write startup report to: " << reportPath_;
+    }
+
+    if (interactiveTime_ < 0) {
+        qCWarning(lcStartup) << "Did not become interactive within " << DEADLINE << " ms";
+    } else if (!isWithinBudget()) {
+        qCWarning(lcStartup) << "Became interactive after " << interactiveTime_ << " ms, over the budget of "
+                             << budget_ << " ms";
+    } else {
+        qCInfo(lcStartup) << "Became interactive after " << interactiveTime_ << " ms";
+    }
+
+    emit finished();
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+QString StartupProfiler::report() const {
+    QString text;
+    QTextStream stream(&text);
+    stream << QCoreApplication::applicationName() << ' ' << QCoreApplication::applicationVersion() << " startup, "
+           << QDateTime::currentDateTime().toString(Qt::ISODate) << "\n\n";
+
+    // One line per phase, with when it finished and how long it took since the one before.
+    stream << QString("%1  %2  %3\n").arg("At (ms)", 8).arg("Took (ms)", 9).arg("Phase");
+    qint64 previous = 0;
+    for (const auto& phase : phases_) {
+        stream << QString("%1  %2  %3\n").arg(phase.time, 8).arg(phase.time - previous, 9).arg(phase.name);
+        previous = phase.time;
+    }
+    stream << '\n';
+
+    if (interactiveTime_ < 0) {
+        stream << "Interactive: not within " << DEADLINE << " ms\n";
+    } else {
+        stream << "Interactive: " << interactiveTime_ << " ms";
+        if (budget_ > 0) {
+            stream << " of a " << budget_ << " ms budget" << (isWithinBudget() ? "" : ", OVER BUDGET");
+        }
+        stream << '\n';
+    }
+
+    if (!awaitedReplies_.isEmpty()) {
+        QStringList plugins = awaitedReplies_.values();
+        plugins.sort();
+        stream << "No reply to: " << plugins.join(", ") << '\n';
+    }
+
+    stream.flush();
+    return text;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
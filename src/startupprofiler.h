@@ -0,0 +1,63 @@
+#ifndef STARTUPPROFILER_H_
+#define STARTUPPROFILER_H_
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QPointer>
+#include <QQuickWindow>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+#include <QVector>
+
+// Times the phases of starting up, from entering main() until the dashboard is interactive and the plugins have heard
+// back from their devices and services. Phases are always timed, since that costs next to nothing, but only reported
+// once started. Interactive means the first frame with the home tab on screen.
+class StartupProfiler final : public QObject {
+    Q_OBJECT
+
+ public:
+    static StartupProfiler* instance();
+
+    void mark(const QString& phase);
+    void start(const QString& reportPath, int budget, const QStringList& plugins);
+    void watch(QQuickWindow* window);
+
+    bool isFinished() const { return isFinished_; }
+    bool isWithinBudget() const;
+
+ signals:
+    void finished();
+
+ private slots:
+    void handleHomeTabLoaded();
+
+ private:
+    struct Phase {
+        QString name;
+        qint64 time;  // Milliseconds since entering main()
+    };
+
+    explicit StartupProfiler(QObject* parent = nullptr);
+
+    QElapsedTimer clock_;
+    QVector<Phase> phases_;
+    bool isEnabled_;
+    bool isFinished_;
+    QString reportPath_;
+    int budget_;              // Milliseconds until interactive, 0 for none
+    qint64 interactiveTime_;  // Milliseconds since entering main(), -1 until interactive
+    QSet<QString> awaitedReplies_;
+    QTimer deadlineTimer_;
+    QPointer<QQuickWindow> window_;
+    QMetaObject::Connection frameSwappedConnection_;
+
+    void checkFinished();
+    void finish();
+    QString report() const;
+
+    Q_DISABLE_COPY_MOVE(StartupProfiler)
+};
+
+#endif  // STARTUPPROFILER_H_
@@ -0,0 +1,101 @@
+#include "timeformatter.h"
+
+#include "logging.h"
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+namespace {
+TimeFormatter* instance_ = nullptr;
+constexpr int MAX_CACHE_SIZE = 64;
+}  // namespace
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+TimeFormatter::TimeFormatter(QObject* parent) : QObject(parent), use24HourClock_(false) {
+    updateFormats();
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+TimeFormatter* TimeFormatter::instance() {
+    if (!instance_) {
+        instance_ = new TimeFormatter();
+    }
+
+    return instance_;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void TimeFormatter::setUse24HourClock(const bool value) {
+    if (use24HourClock_ != value) {
+        use24HourClock_ = value;
+        updateFormats();
+
+        // Let everything showing times know, dropping any that have gone away.
+        for (int i = consumers_.size() - 1; i >= 0; i--) {
+            if (consumers_.at(i).object) {
+                consumers_.at(i).update();
+            } else {
+                consumers_.removeAt(i);
+            }
+        }
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+QString TimeFormatter::time(const QDateTime& dateTime) {
+    return format(timeCache_, 60, dateTime, timeFormat_);
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+QString TimeFormatter::hour(const QDateTime& dateTime) {
+    return format(hourCache_, 60 * 60, dateTime, hourFormat_);
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void TimeFormatter::subscribe(QObject* consumer, const std::function<void()>& update) {
+    if (!consumer || !update) {
+        qCWarning(lcHub) << "Ignoring invalid time format consumer";
+        return;
+    }
+
+    consumers_.append(Consumer{consumer, update});
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void TimeFormatter::updateFormats() {
+    timeFormat_ = use24HourClock_ ? "hh:mm" : "h:mm AP";
+    hourFormat_ = use24HourClock_ ? "hh:00" : "h AP";
+
+    // Everything formatted so far is in the wrong mode now.
+    timeCache_.clear();
+    hourCache_.clear();
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+QString TimeFormatter::format(QHash<CacheKey, QString>& cache,
+                              const int period,
+                              const QDateTime& dateTime,
+                              const QString& format) {
+    if (!dateTime.isValid()) {
+        return QString();
+    }
+
+    // Count periods of local time, since with an offset that is not a whole number of hours (e.g. UTC+5:30) one UTC
+    // hour spans two local ones.
+    int offset = dateTime.offsetFromUtc();
+    CacheKey key((dateTime.toSecsSinceEpoch() + offset) / period, offset);
+
+    auto it = cache.constFind(key);
+    if (it != cache.constEnd()) {
+        return it.value();
+    }
+
+    // Only a handful of distinct times are on screen at once, so rather than tracking what is least recently used
+    // just start over when the cache fills up.
+    if (cache.size() >= MAX_CACHE_SIZE) {
+        cache.clear();
+    }
+
+    QString formatted = dateTime.toString(format);
+    cache.insert(key, formatted);
+    return formatted;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,60 @@
+#ifndef TIMEFORMATTER_H_
+#define TIMEFORMATTER_H_
+
+#include <QDateTime>
+#include <QHash>
+#include <QObject>
+#include <QPair>
+#include <QPointer>
+#include <QString>
+#include <QVector>
+
+#include <functional>
+
+// Formats times for display according to the clock mode. Anything showing formatted times subscribes once to be told
+// when the clock mode changes, rather than everything with a date being poked.
+class TimeFormatter final : public QObject {
+    Q_OBJECT
+
+ public:
+    static TimeFormatter* instance();
+
+    bool use24HourClock() const { return use24HourClock_; }
+    void setUse24HourClock(bool value);
+
+    QString time(const QDateTime& dateTime);  // Hours and minutes
+    QString hour(const QDateTime& dateTime);  // Just the hour
+
+    void subscribe(QObject* consumer, const std::function<void()>& update);
+
+    int cacheSize() const { return timeCache_.size() + hourCache_.size(); }
+
+ private:
+    struct Consumer {
+        QPointer<QObject> object;
+        std::function<void()> update;
+    };
+
+    // Local minutes or hours since the epoch, along with the offset from UTC in seconds so that the same instant in
+    // different zones is kept apart.
+    using CacheKey = QPair<qint64, int>;
+
+    explicit TimeFormatter(QObject* parent = nullptr);
+
+    bool use24HourClock_;
+    QString timeFormat_;
+    QString hourFormat_;
+    QHash<CacheKey, QString> timeCache_;  // Key: local minutes
+    QHash<CacheKey, QString> hourCache_;  // Key: local hours
+    QVector<Consumer> consumers_;
+
+    void updateFormats();
+    static QString format(QHash<CacheKey, QString>& cache,
+                          int period,
+                          const QDateTime& dateTime,
+                          const QString& format);
+
+    Q_DISABLE_COPY_MOVE(TimeFormatter)
+};
+
+#endif  // TIMEFORMATTER_H_
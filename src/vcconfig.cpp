@@ -1,28 +1,51 @@
 #include "vcconfig.h"
 
-#include <QDebug>
+#include <QCoreApplication>
+#include <QCryptographicHash>
 #include <QFileInfo>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QSaveFile>
+#include <QtConcurrent>
 
+#include "logging.h"
+#include "profiler.h"
 #include "vchub.h"
 /*--------------------------------------------------------------------------------------------------------------------*/
 
 namespace {
 VCConfig* instance_ = nullptr;
+constexpr int SAVE_DELAY = 2 * 1000;          // Quiet time to wait for before saving
+constexpr qint64 MAX_SAVE_DELAY = 10 * 1000;  // Longest a change can go unsaved while others keep coming in
 }  // namespace
 /*--------------------------------------------------------------------------------------------------------------------*/
 
-VCConfig::VCConfig(QObject* parent) : QObject(parent) {
-    // Find our save slot in the Meta-Object system.
+VCConfig::VCConfig(QObject* parent)
+    : QObject(parent), loadedCount_(0), isLoading_(false), writeCount_(0), writesAvoidedCount_(0) {
+    // Find our change handler in the Meta-Object system.
     const QMetaObject* meta = metaObject();
     for (int i = 0; i < meta->methodCount(); i++) {
         QMetaMethod method = meta->method(i);
-        if (method.name() == "save") {
-            saveMethod_ = method;
+        if (method.name() == "handlePropertyChanged") {
+            propertyChangedMethod_ = method;
             break;
         }
     }
+
+    // Changes are collected for a while before saving, so a burst of them (like dragging a slider) is one write.
+    saveTimer_.setSingleShot(true);
+    connect(&saveTimer_, &QTimer::timeout, this, &VCConfig::save);
+
+    // Writes happen off of the GUI thread, but still one at a time so they land in order.
+    writePool_.setMaxThreadCount(1);
+
+    // Don't lose any changes that are still waiting when exiting.
+    connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, [this] {
+        if (saveTimer_.isActive()) {
+            (void)save();
+        }
+        writePool_.waitForDone();
+    });
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
 
@@ -35,74 +58,93 @@ VCConfig* VCConfig::instance() {
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
 
-bool VCConfig::load(const QString& path) {
-    if (!QFile::exists(path) || !QFileInfo(path).isWritable()) {
-        qWarning() << "Ignoring config file path because it does not refer to an existing, writable file: " << path;
+bool VCConfig::load(const QString& configPath) {
+    if (!QFile::exists(configPath) || !QFileInfo(configPath).isWritable()) {
+        qCWarning(lcConfig) << "Ignoring config file path because it does not refer to an existing, writable file: "
+                            << configPath;
         return false;
     }
 
+    // Compare against the last path by where it points, since the same file can be given relative or absolute.
+    QString path = QFileInfo(configPath).absoluteFilePath();
+
+    if ((path_ == path) && (pendingWriteCount_.loadAcquire() > 0)) {
+        // What is on disk is about to be replaced with newer values, so don't apply it. Finishing the write will
+        // trigger another look.
+        qCDebug(lcConfig) << "Not reloading config file while saving it";
+        return true;
+    }
+
     QFile configFile(path);
     if (!configFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        qWarning() << "Failed to open config file: " << path;
+        qCWarning(lcConfig) << "Failed to open config file: " << path;
         return false;
     }
 
-    qDebug() << "Loading config file: " << path;
-    QJsonDocument configDocument = QJsonDocument::fromJson(configFile.readAll());
+    qCInfo(lcConfig) << "Loading config file: " << path;
+    QByteArray configData = configFile.readAll();
+    QJsonDocument configDocument = QJsonDocument::fromJson(configData);
     if (!configDocument.isObject()) {
-        qWarning() << "Failed to parse config file structure: " << path;
+        qCWarning(lcConfig) << "Failed to parse config file structure: " << path;
         configFile.close();
         return false;
     }
 
+    // Skip everything if the file is exactly what was last loaded or written, like after saving.
+    QByteArray contentHash = QCryptographicHash::hash(configData, QCryptographicHash::Sha1);
+    if ((path_ == path) && (contentHash_ == contentHash)) {
+        qCDebug(lcConfig) << "Config file is unchanged";
+        return true;
+    }
+
     QJsonObject config = configDocument.object();
-    keys_.clear();
-    const QStringList keys = config.keys();
-    for (const auto& key : keys) {
-        KeyContext context = keyToContext(key);
-        QObject* object = context.first;
-        QString property = context.second;
-
-        if (!object || property.isEmpty()) {
-            qWarning() << "Ignoring config key because it does not resolve: " << key;
-            continue;
+    QSet<int> previousBindings;
+    for (int i = 0; i < bindings_.size(); i++) {
+        if (bindings_.at(i).isLoaded) {
+            previousBindings.insert(i);
+            bindings_[i].isLoaded = false;
         }
+    }
+    loadedCount_ = 0;
 
-        if (!object->property(property.toStdString().c_str()).isValid()) {
-            qWarning() << "Ignoring config key because the property does not exist: " << key;
+    // Changes made while applying the file are not worth saving back to it.
+    isLoading_ = true;
+    int appliedCount = 0;
+    for (auto it = config.constBegin(); it != config.constEnd(); ++it) {
+        int index = bind(it.key());
+        if (index < 0) {
             continue;
         }
 
-        // Find the property's NOTIFY signal to drive saving back the file.
-        QMetaMethod notifySignal;
-        const QMetaObject* meta = object->metaObject();
-        for (int i = 0; i < meta->propertyCount(); i++) {
-            QMetaProperty metaProperty = meta->property(i);
-            if (property == metaProperty.name()) {
-                if (metaProperty.hasNotifySignal()) {
-                    notifySignal = metaProperty.notifySignal();
-
-                    // Break any existing connection to prevent an unintended save while loading.
-                    disconnect(object, notifySignal, this, saveMethod_);
-                    break;
-                } else {
-                    qWarning() << "No NOTIFY signal for property in config key: " << key;
-                }
-            }
+        Binding& binding = bindings_[index];
+        binding.isLoaded = true;
+        loadedCount_++;
+        if (previousBindings.contains(index) && (binding.value == it.value())) {
+            // Unchanged since it was last applied, so leave the property (and any unsaved change to it) alone rather
+            // than kicking off whatever depends on it again.
+            continue;
         }
 
-        // Set the property to the value specified in the file.
-        object->setProperty(property.toStdString().c_str(), config.value(key).toVariant());
-
-        // Save the key name to track it now that is has been validated.
-        keys_.append(key);
-
-        // Connect or reconnect the notify signal.
-        if (notifySignal.isValid()) {
-            connect(object, notifySignal, this, saveMethod_);
+        // Set the property to the value specified in the file, keeping the value as it will be written back.
+        if (!binding.property.write(binding.object, it.value().toVariant())) {
+            qCWarning(lcConfig) << "Failed to apply config key: " << it.key();
         }
+        binding.value = QJsonValue::fromVariant(binding.property.read(binding.object));
+        dirtyBindings_.remove(index);
+        appliedCount++;
     }
+    isLoading_ = false;
 
+    // The file is now the reference for anything it changed or dropped.
+    for (auto it = dirtyBindings_.begin(); it != dirtyBindings_.end();) {
+        it = bindings_.at(*it).isLoaded ? std::next(it) : dirtyBindings_.erase(it);
+    }
+    if (dirtyBindings_.isEmpty()) {
+        saveTimer_.stop();
+    }
+
+    qCInfo(lcConfig) << "Applied " << appliedCount << " of " << loadedCount_ << " config keys";
+    contentHash_ = contentHash;
     path_ = path;
     configFile.close();
     return true;
@@ -110,43 +152,152 @@ bool VCConfig::load(const QString& path) {
 /*--------------------------------------------------------------------------------------------------------------------*/
 
 bool VCConfig::save() {
-    if (path_.isEmpty() || keys_.isEmpty()) {
-        qDebug() << "Not saving config because one was not previously loaded";
+    if (path_.isEmpty() || (loadedCount_ == 0)) {
+        qCWarning(lcConfig) << "Not saving config because one was not previously loaded";
         return false;
     }
 
-    bool success = false;
-    QJsonObject config;
-    for (const auto& key : qAsConst(keys_)) {
-        KeyContext context = keyToContext(key);
-        QObject* object = context.first;
-        QString property = context.second;
-
-        // This should always resolve since this is a validated key, but do a sanity check anyway.
-        if (!object || property.isEmpty()) {
-            qWarning() << "Not saving config key because it does not resolve: " << key;
+    Profiler::Scope scope("config", QStringLiteral("Save"));
+    saveTimer_.stop();
+
+    // Only the keys which changed need to be serialized again.
+    bool changed = false;
+    for (int index : qAsConst(dirtyBindings_)) {
+        Binding& binding = bindings_[index];
+
+        // The object may have gone away since the key was compiled, do a sanity check.
+        if (!binding.object) {
+            qCWarning(lcConfig) << "Not saving config key because it no longer resolves: " << binding.key;
             continue;
         }
 
         // Record the latest property value.
-        config[key] = QJsonValue::fromVariant(object->property(property.toStdString().c_str()));
+        QJsonValue value = QJsonValue::fromVariant(binding.property.read(binding.object));
+        if (binding.value != value) {
+            binding.value = value;
+            changed = true;
+        }
     }
+    dirtyBindings_.clear();
 
-    if (!config.isEmpty()) {
-        QFile configFile(path_);
-        if (configFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
-            configFile.write(QJsonDocument(config).toJson());
-            configFile.close();
-            qDebug() << "Saved config file: " << path_;
-            success = true;
+    if (!changed) {
+        // Everything ended up back where it was.
+        countWriteAvoided();
+        return true;
+    }
+
+    // QSaveFile writes to a temporary file, syncs it to disk, and then renames it over the original, so a power
+    // cut can never leave behind a partially written config.
+    QJsonObject config;
+    for (const auto& binding : qAsConst(bindings_)) {
+        if (binding.isLoaded) {
+            config.insert(binding.key, binding.value);
+        }
+    }
+    QString path = path_;
+    QByteArray data = QJsonDocument(config).toJson();
+    contentHash_ = QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+    pendingWriteCount_.ref();
+    (void)QtConcurrent::run(&writePool_, [this, path, data] {
+        QSaveFile configFile(path);
+        if (!configFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+            qCWarning(lcConfig) << "Failed to open config file when trying to save: " << path;
         } else {
-            qWarning() << "Failed to open config file when trying to save: " << path_;
+            configFile.write(data);
+            if (configFile.commit()) {
+                qCInfo(lcConfig) << "Saved config file: " << path;
+            } else {
+                qCWarning(lcConfig) << "Failed to write config file: " << path;
+            }
         }
+        pendingWriteCount_.deref();
+    });
+
+    writeCount_++;
+    emit writeCountChanged();
+    return true;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void VCConfig::handlePropertyChanged() {
+    if (isLoading_) {
+        return;
+    }
+
+    bool isDirty = false;
+    const QVector<int> indexes = notifyBindings_.value({sender(), senderSignalIndex()});
+    for (int index : indexes) {
+        if (bindings_.at(index).isLoaded) {
+            dirtyBindings_.insert(index);
+            isDirty = true;
+        }
+    }
+    if (!isDirty) {
+        // Not a property in the current config.
+        return;
+    }
+
+    if (saveTimer_.isActive()) {
+        // This change will be part of the pending save, where it would have been a write of its own before.
+        countWriteAvoided();
+    } else {
+        dirtyTimer_.start();
+    }
+
+    // Wait for things to settle, but not forever.
+    qint64 remaining = MAX_SAVE_DELAY - dirtyTimer_.elapsed();
+    saveTimer_.start(static_cast<int>(qBound<qint64>(0, remaining, SAVE_DELAY)));
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int VCConfig::bind(const QString& key) {
+    // Reuse the compiled binding as long as its object is still around.
+    int index = bindingIndexes_.value(key, -1);
+    if ((index >= 0) && bindings_.at(index).object) {
+        return index;
+    }
+
+    KeyContext context = keyToContext(key);
+    QObject* object = context.first;
+    if (!object || context.second.isEmpty()) {
+        qCWarning(lcConfig) << "Ignoring config key because it does not resolve: " << key;
+        return -1;
+    }
+
+    const QMetaObject* meta = object->metaObject();
+    QMetaProperty property = meta->property(meta->indexOfProperty(context.second.toUtf8().constData()));
+    if (!property.isValid()) {
+        qCWarning(lcConfig) << "Ignoring config key because the property does not exist: " << key;
+        return -1;
+    }
+
+    if (index < 0) {
+        index = bindings_.size();
+        bindings_.append(Binding{key, object, property, QJsonValue(), false});
+        bindingIndexes_.insert(key, index);
+    } else {
+        // The object was replaced, point the binding at the new one and make sure the value gets applied to it.
+        bindings_[index].object = object;
+        bindings_[index].property = property;
+        bindings_[index].value = QJsonValue(QJsonValue::Undefined);
+    }
+
+    // Drive saving back to the file from the property's NOTIFY signal.
+    if (property.hasNotifySignal()) {
+        QMetaMethod notifySignal = property.notifySignal();
+        notifyBindings_[{object, notifySignal.methodIndex()}].append(index);
+        connect(object, notifySignal, this, propertyChangedMethod_, Qt::UniqueConnection);
     } else {
-        qWarning() << "Failed to build config file structure when trying to save";
+        qCWarning(lcConfig) << "No NOTIFY signal for property in config key: " << key;
     }
 
-    return success;
+    return index;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void VCConfig::countWriteAvoided() {
+    writesAvoidedCount_++;
+    emit writesAvoidedCountChanged();
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
 
@@ -1,33 +1,83 @@
 #ifndef VCCONFIG_H_
 #define VCCONFIG_H_
 
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonValue>
 #include <QList>
 #include <QMetaMethod>
+#include <QMetaProperty>
 #include <QObject>
+#include <QPointer>
+#include <QSet>
 #include <QString>
+#include <QThreadPool>
+#include <QTimer>
 #include <QVariant>
+#include <QVector>
 
 using KeyContext = QPair<QObject*, QString>;  // Object, property name
+using SignalContext = QPair<QObject*, int>;   // Object, signal index
 
 class VCConfig final : public QObject {
     Q_OBJECT
 
+    // clang-format off
+    Q_PROPERTY(int writeCount          READ writeCount          NOTIFY writeCountChanged)
+    Q_PROPERTY(int writesAvoidedCount  READ writesAvoidedCount  NOTIFY writesAvoidedCountChanged)
+    // clang-format on
+
  public:
     static VCConfig* instance();
 
+    int writeCount() const { return writeCount_; }
+    int writesAvoidedCount() const { return writesAvoidedCount_; }
+
     bool load(const QString& path);
 
  public slots:
     bool save();
 
+ signals:
+    void writeCountChanged();
+    void writesAvoidedCountChanged();
+
+ private slots:
+    void handlePropertyChanged();
+
  private:
+    // A config key compiled down to the property it refers to.
+    struct Binding {
+        QString key;
+        QPointer<QObject> object;
+        QMetaProperty property;
+        QJsonValue value;  // As last loaded or written
+        bool isLoaded;     // Whether the key is in the current config file
+    };
+
     explicit VCConfig(QObject* parent = nullptr);
 
     QString path_;
-    QStringList keys_;
-    QMetaMethod saveMethod_;
+    QVector<Binding> bindings_;                          // Compiled once per key and reused across loads
+    QHash<QString, int> bindingIndexes_;                 // Key: config key, Value: index into bindings_
+    QHash<SignalContext, QVector<int>> notifyBindings_;  // Bindings behind each NOTIFY signal
+    QSet<int> dirtyBindings_;
+    QByteArray contentHash_;  // Of the file as last loaded or written
+    int loadedCount_;
+    bool isLoading_;
+    QMetaMethod propertyChangedMethod_;
+    QTimer saveTimer_;
+    QElapsedTimer dirtyTimer_;  // Since the oldest unsaved change
+    QAtomicInt pendingWriteCount_;
+    QThreadPool writePool_;  // After anything the writes touch, so it finishes them first when destroyed.
+    int writeCount_;
+    int writesAvoidedCount_;
 
+    int bind(const QString& key);
     KeyContext keyToContext(const QString& key);
+    void countWriteAvoided();
 
     Q_DISABLE_COPY_MOVE(VCConfig)
 };
@@ -2,6 +2,7 @@
 
 #include <QJsonObject>
 
+#include "logging.h"
 #include "networkinterface.h"
 /*--------------------------------------------------------------------------------------------------------------------*/
 
@@ -12,6 +13,7 @@ VCFacts::VCFacts(const QString& name, QObject* parent)
 
     // Handle network responses.
     connect(NetworkInterface::instance(), &NetworkInterface::jsonReplyReceived, this, &VCFacts::handleNetworkReply);
+    NetworkInterface::instance()->addKnownHost(requestURL_);
 
     refresh();
 }
@@ -28,11 +30,11 @@ void VCFacts::handleNetworkReply(const int statusCode, QObject* const sender, co
         return;
     }
     if (statusCode != 200) {
-        qDebug() << "Ignoring bad reply when requesting fact";
+        qCWarning(lcFacts) << "Ignoring bad reply when requesting fact";
         return;
     }
     if (!body.isObject()) {
-        qDebug() << "Failed to parse facts response";
+        qCWarning(lcFacts) << "Failed to parse facts response";
         return;
     }
 
@@ -43,7 +45,7 @@ void VCFacts::handleNetworkReply(const int statusCode, QObject* const sender, co
             fact_ = fact;
             emit factChanged();
         } else {
-            qDebug() << "No fact received in reply";
+            qCWarning(lcFacts) << "No fact received in reply";
         }
     }
 }
@@ -1,10 +1,11 @@
 #include "vchub.h"
 
+#include <QColor>
 #include <QCoreApplication>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QFile>
 #include <QJsonObject>
-#include <QLocale>
 #include <QNetworkInterface>
 #include <QStandardPaths>
 #include <QSysInfo>
@@ -12,12 +13,17 @@
 #include "hueambiancelight.h"
 #include "huecolorlight.h"
 #include "huelight.h"
+#include "logging.h"
+#include "memorymonitor.h"
+#include "metrics.h"
 #include "networkinterface.h"
+#include "numberformatter.h"
 #include "vcconfig.h"
 /*--------------------------------------------------------------------------------------------------------------------*/
 
 namespace {
 VCHub* instance_ = nullptr;
+constexpr int MINUTE = 60 * 1000;
 }  // namespace
 /*--------------------------------------------------------------------------------------------------------------------*/
 
@@ -25,11 +31,11 @@ VCHub::VCHub(QObject* parent)
     : QObject(parent),
       isActive_(true),
       currentDateTime_(QDateTime::currentDateTime()),
+      addressMonitor_(new AddressMonitor(this)),
       hostname_(QHostInfo::localHostName()),
       platform_(QSysInfo::prettyProductName().split('(').first().trimmed()),
       architecture_(QSysInfo::currentCpuArchitecture()),
       qtVersion_(qVersion()),
-      use24HourClock_(false),
       darkerBackground_(false),
       screensaverEnabled_(true),
       hue_(new VCHue("Hue", this)),
@@ -40,30 +46,71 @@ VCHub::VCHub(QObject* parent)
       spotify_(new VCSpotify("Spotify", this)),
       isRunningScene_(false) {
     setObjectName("Hub");
-    qDebug() << "Initializing dashboard hub";
+    qCInfo(lcHub) << "Initializing dashboard hub";
 
-    // Take ownership of the network interface.
+    // Take ownership of the network interface, formatters, metrics, and profilers.
+    MemoryMonitor::instance()->setParent(this);
+    Metrics::instance()->setParent(this);
     NetworkInterface::instance()->setParent(this);
+    NumberFormatter::instance()->setParent(this);
+    Profiler::instance()->setParent(this);
+    TimeFormatter::instance()->setParent(this);
 
-#ifdef QT_DEBUG
-    // Reload the config file if it changes externally.
-    connect(&configFileWatcher_, &QFileSystemWatcher::fileChanged, this, [this](const QString& path) {
-        qDebug() << "Reloading config file because it has changed externally";
-        (void)loadConfig(path);
+    // Count property changes of each plugin, which needs their full meta-objects.
+    for (VCPlugin* plugin : plugins()) {
+        plugin->trackStateChanges();
+    }
+
+    // Publish the counters kept elsewhere when metrics are scraped.
+    Metrics::instance()->addCollector([] {
+        Metrics* metrics = Metrics::instance();
+        NumberFormatter* numberFormatter = NumberFormatter::instance();
+        VCConfig* config = VCConfig::instance();
+        metrics->gauge("vc_number_format_requests", "Numbers requested from the formatter.")
+            ->set(static_cast<double>(numberFormatter->requestCount()));
+        metrics->gauge("vc_number_format_misses", "Numbers formatted rather than served from the cache.")
+            ->set(static_cast<double>(numberFormatter->formatCount()));
+        metrics->gauge("vc_config_writes", "Config file writes.")->set(config->writeCount());
+        metrics->gauge("vc_config_writes_avoided", "Config saves coalesced or skipped.")
+            ->set(config->writesAvoidedCount());
     });
-#endif
 
-    // Periodically refresh the current date and time.
-    currentDateTimeRefreshTimer_.setInterval(10 * 1000);
-    currentDateTimeRefreshTimer_.setSingleShot(false);
+    // Watch what could keep growing while running for weeks.
+    MemoryMonitor* memoryMonitor = MemoryMonitor::instance();
+    memoryMonitor->watchSize("Number cache", [] { return NumberFormatter::instance()->cacheSize(); });
+    memoryMonitor->watchSize("Time cache", [] { return TimeFormatter::instance()->cacheSize(); });
+    memoryMonitor->watchSize("Scenes", [this] { return scenes_.size(); });
+    memoryMonitor->watchSize("PiHole history", [this] { return pihole_->historicalData().size(); });
+    memoryMonitor->watchSize("Spotify playlists", [this] { return spotify_->playlists()->count(); });
+    memoryMonitor->watchSize("Spotify devices", [this] { return spotify_->devices().size(); });
+    memoryMonitor->watchSize("Spotify search results", [this] { return spotify_->searchResults()->count(); });
+
+    // Update the time display right away when the clock mode changes.
+    TimeFormatter::instance()->subscribe(this, [this] { updateCurrentDateTime(); });
+
+    // Reload the config file if it changes externally, giving editors a moment to finish writing it.
+    configReloadTimer_.setInterval(250);
+    configReloadTimer_.setSingleShot(true);
+    connect(&configReloadTimer_, &QTimer::timeout, this, &VCHub::reloadConfig);
+    connect(&configFileWatcher_, &QFileSystemWatcher::fileChanged, &configReloadTimer_, qOverload<>(&QTimer::start));
+    connect(
+        &configFileWatcher_, &QFileSystemWatcher::directoryChanged, &configReloadTimer_, qOverload<>(&QTimer::start));
+
+    // Refresh the current date and time as each minute starts, since that is all that is shown.
+    // A coarse timer may fire a few seconds early, which would land in the previous minute.
+    currentDateTimeRefreshTimer_.setSingleShot(true);
+    currentDateTimeRefreshTimer_.setTimerType(Qt::PreciseTimer);
     connect(&currentDateTimeRefreshTimer_, &QTimer::timeout, this, &VCHub::updateCurrentDateTime);
-    currentDateTimeRefreshTimer_.start();
+    scheduleCurrentDateTimeRefresh();
 
-    // Periodically refresh the IP addresses.
+    // Refresh the IP addresses whenever they change, falling back to polling if that cannot be watched.
+    connect(addressMonitor_, &AddressMonitor::addressesChanged, this, &VCHub::refreshIPAddresses);
     ipAddressesRefreshTimer_.setInterval(15 * 1000);
     ipAddressesRefreshTimer_.setSingleShot(false);
     connect(&ipAddressesRefreshTimer_, &QTimer::timeout, this, &VCHub::refreshIPAddresses);
-    ipAddressesRefreshTimer_.start();
+    if (!addressMonitor_->isActive()) {
+        ipAddressesRefreshTimer_.start();
+    }
     refreshIPAddresses();
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
@@ -78,14 +125,17 @@ VCHub* VCHub::instance() {
 /*--------------------------------------------------------------------------------------------------------------------*/
 
 void VCHub::setActive(const bool value) {
-    static const QList<VCPlugin*> plugins{hue_, nanoleaf_, pihole_, weather_, facts_, spotify_};
-
     if (isActive_ != value) {
         isActive_ = value;
         emit isActiveChanged();
 
+        // Waking up is about to send a request to every host at once, so get their connections going first.
+        if (value) {
+            NetworkInterface::instance()->preconnect();
+        }
+
         // Propagate the active state to each plugin.
-        for (auto plugin : plugins) {
+        for (auto plugin : plugins()) {
             plugin->setActive(value);
         }
     }
@@ -93,25 +143,10 @@ void VCHub::setActive(const bool value) {
 /*--------------------------------------------------------------------------------------------------------------------*/
 
 void VCHub::setUse24HourClock(const bool value) {
-    if (use24HourClock_ != value) {
-        use24HourClock_ = value;
+    if (TimeFormatter::instance()->use24HourClock() != value) {
+        // Everything showing times has subscribed to the formatter to be redisplayed.
+        TimeFormatter::instance()->setUse24HourClock(value);
         emit use24HourClockChanged();
-
-        // Update the time display right away.
-        updateCurrentDateTime();
-
-        // Indicate that any QDateTime properties should be reevaluated by emitting the NOTIFY signal.
-        const QObjectList childrenList = children();
-        for (auto child : childrenList) {
-            const QMetaObject* childMeta = child->metaObject();
-            int propertyCount = childMeta->propertyCount();
-            for (int i = 0; i < propertyCount; i++) {
-                QMetaProperty property = childMeta->property(i);
-                if ((property.type() == QVariant::DateTime) && property.hasNotifySignal()) {
-                    property.notifySignal().invoke(child);
-                }
-            }
-        }
     }
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
@@ -127,35 +162,72 @@ bool VCHub::loadConfig(const QString& path) {
             emit homeMapChanged();
         }
 
-#ifdef QT_DEBUG
-        // Watch the config file on disk.
-        if (configFileWatcher_.files().isEmpty()) {
-            configFileWatcher_.addPath(path);
+        // Watch the config file on disk, along with its directory to catch it being replaced.
+        QString configPath = QFileInfo(path).absoluteFilePath();
+        if (configPath_ != configPath) {
+            if (!configFileWatcher_.files().isEmpty()) {
+                (void)configFileWatcher_.removePaths(configFileWatcher_.files());
+            }
+            if (!configFileWatcher_.directories().isEmpty()) {
+                (void)configFileWatcher_.removePaths(configFileWatcher_.directories());
+            }
+            configPath_ = configPath;
+            (void)configFileWatcher_.addPath(configPath_);
+            (void)configFileWatcher_.addPath(QFileInfo(configPath_).absolutePath());
         }
-#endif
     }
 
     return success;
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
 
+void VCHub::reloadConfig() {
+    if (!QFile::exists(configPath_)) {
+        // Likely in the middle of being replaced, wait for it to show back up in the directory.
+        return;
+    }
+
+    // Editors (and saving the config) replace the file by renaming over it, which drops it from the watcher.
+    if (!configFileWatcher_.files().contains(configPath_)) {
+        (void)configFileWatcher_.addPath(configPath_);
+    }
+
+    qCInfo(lcHub) << "Reloading config file because it may have changed externally";
+    (void)loadConfig(configPath_);
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
 void VCHub::runScene(const QString& scene) {
     QVariantList steps = extractSceneSteps(scene);
     if (steps.isEmpty()) {
         // No steps, assume this means the scene was not found.
-        qDebug() << "Ignoring request to run unknown scene: " << scene;
+        qCWarning(lcHub) << "Ignoring request to run unknown scene: " << scene;
         return;
     }
 
     // Indicate that execution is starting.
     isRunningScene_ = true;
     emit isRunningSceneChanged();
+    QElapsedTimer sceneClock;
+    sceneClock.start();
+    SceneMetrics metrics = sceneMetrics(scene);
+    metrics.runs->increment();
 
     // Scenes steps are constructed as a list of objects that contain device and state information.
-    qDebug() << "Processing scene " << scene << " with " << steps.size() << " steps";
+    qCInfo(lcHub) << "Processing scene " << scene << " with " << steps.size() << " steps";
     for (int i = 0; i < steps.size(); i++) {
+        // Insert a brief pause in between steps to prevent overloading the devices.
+        if (i > 0) {
+            QTime future = QTime::currentTime().addMSecs(200);
+            while (future > QTime::currentTime()) {
+                QCoreApplication::processEvents(QEventLoop::AllEvents, 500);
+            }
+        }
+
+        // Only the step itself is profiled, anything that runs during the pause is accounted for on its own.
         int stepNumber = i + 1;
         QVariantMap step = steps.at(i).toMap();
+        Profiler::Scope scope("scene", scene, stepNumber);
 
         // Ensure the expected structure is present.
         if (step.contains("device") && step.contains("state")) {
@@ -163,6 +235,7 @@ void VCHub::runScene(const QString& scene) {
             QString name = device.value("name").toString();
             QString className = device.value("class").toString();
             QVariantMap state = step.value("state").toMap();
+            sceneStepCount(className)->increment();
 
             // Execute the actions of the step based on the device class.
             if (className == "hue") {
@@ -178,110 +251,120 @@ void VCHub::runScene(const QString& scene) {
 
                 // Check if the device has been discovered.
                 if (hueDevice) {
-                    qDebug() << "Executing step " << stepNumber << " on Hue device: " << name;
+                    qCDebug(lcHub) << "Executing step " << stepNumber << " on Hue device: " << name;
 
                     // Apply state properties from most to least generic.
                     if (state.contains("on")) {
-                        qDebug() << "\t=> Command power";
+                        qCDebug(lcHub) << "\t=> Command power";
                         hueDevice->commandPower(state.take("on").toBool());
                     }
                     if (state.contains("brightness")) {
                         // This must be a light.
                         auto hueLight = qobject_cast<HueLight*>(hueDevice);
                         if (hueLight) {
-                            qDebug() << "\t=> Command brightness";
+                            qCDebug(lcHub) << "\t=> Command brightness";
                             hueLight->commandBrightness(state.take("brightness").toDouble());
                         } else {
                             state.remove("brightness");  // Still consume the value
-                            qDebug() << "Encountered brightness command for Hue device " << name
-                                     << " that is not a light in step " << stepNumber
-                                     << " when processing scene: " << scene;
+                            qCWarning(lcHub) << "Encountered brightness command for Hue device " << name
+                                             << " that is not a light in step " << stepNumber
+                                             << " when processing scene: " << scene;
                         }
                     }
                     if (state.contains("colorTemperature")) {
                         // This must be an ambiance light.
                         auto hueLight = qobject_cast<HueAmbianceLight*>(hueDevice);
                         if (hueLight) {
-                            qDebug() << "\t=> Command color temperature";
+                            qCDebug(lcHub) << "\t=> Command color temperature";
                             hueLight->commandColorTemperature(state.take("colorTemperature").toInt());
                         } else {
                             state.remove("colorTemperature");  // Still consume the value
-                            qDebug() << "Encountered color temperature command for Hue device " << name
-                                     << " that is not an ambiance light in step " << stepNumber
-                                     << " when processing scene: " << scene;
+                            qCWarning(lcHub) << "Encountered color temperature command for Hue device " << name
+                                             << " that is not an ambiance light in step " << stepNumber
+                                             << " when processing scene: " << scene;
                         }
                     }
                     if (state.contains("xy")) {
                         // This must be a color light.
                         auto hueLight = qobject_cast<HueColorLight*>(hueDevice);
                         if (hueLight) {
-                            qDebug() << "\t=> Command XY color";
+                            qCDebug(lcHub) << "\t=> Command XY color";
                             QVariantList xy = state.take("xy").toList();
                             hueLight->commandColor(xy.at(0).toDouble(), xy.at(1).toDouble());
                         } else {
                             state.remove("xy");  // Still consume the value
-                            qDebug() << "Encountered XY color command for Hue device " << name
-                                     << " that is not a color light in step " << stepNumber
-                                     << " when processing scene: " << scene;
+                            qCWarning(lcHub) << "Encountered XY color command for Hue device " << name
+                                             << " that is not a color light in step " << stepNumber
+                                             << " when processing scene: " << scene;
                         }
                     }
                     if (state.contains("hue")) {
                         // This must be a color light.
                         auto hueLight = qobject_cast<HueColorLight*>(hueDevice);
                         if (hueLight) {
-                            qDebug() << "\t=> Command hue color";
+                            qCDebug(lcHub) << "\t=> Command hue color";
                             hueLight->commandColor(state.take("hue").toInt());
                         } else {
                             state.remove("hue");  // Still consume the value
-                            qDebug() << "Encountered hue color command for Hue device " << name
-                                     << " that is not a color light in step " << stepNumber
-                                     << " when processing scene: " << scene;
+                            qCWarning(lcHub) << "Encountered hue color command for Hue device " << name
+                                             << " that is not a color light in step " << stepNumber
+                                             << " when processing scene: " << scene;
                         }
                     }
                     if (!state.isEmpty()) {
-                        qDebug() << "Detected unsupported state properties " << state.keys() << " for Hue device "
-                                 << name << " in step " << stepNumber << " when processing scene: " << scene;
+                        qCWarning(lcHub) << "Detected unsupported state properties " << state.keys()
+                                         << " for Hue device " << name << " in step " << stepNumber
+                                         << " when processing scene: " << scene;
                     }
                 } else {
-                    qDebug() << "Encountered unknown Hue device name " << name << " in step " << stepNumber
-                             << " when processing scene: " << scene;
+                    qCWarning(lcHub) << "Encountered unknown Hue device name " << name << " in step " << stepNumber
+                                     << " when processing scene: " << scene;
                 }
             } else if (className == "nanoleaf") {
                 // Ensure this is the discovered Nanoleaf.
                 if (name == nanoleaf_->name()) {
-                    qDebug() << "Executing step " << stepNumber << " on Nanoleaf: " << name;
+                    qCDebug(lcHub) << "Executing step " << stepNumber << " on Nanoleaf: " << name;
                     if (state.contains("on")) {
-                        qDebug() << "\t=> Command power";
+                        qCDebug(lcHub) << "\t=> Command power";
                         nanoleaf_->commandPower(state.take("on").toBool());
                     }
                     if (state.contains("effect")) {
-                        qDebug() << "\t=> Select effect";
+                        qCDebug(lcHub) << "\t=> Select effect";
                         nanoleaf_->selectEffect(state.take("effect").toString());
                     }
+                    if (state.contains("panels")) {
+                        // Each panel is given its own color, which is streamed until an effect is selected again.
+                        qCDebug(lcHub) << "\t=> Stream panel colors";
+                        if (!nanoleaf_->isStreaming()) {
+                            nanoleaf_->startStreaming();
+                        }
+                        const QVariantList panels = state.take("panels").toList();
+                        for (const auto& panel : panels) {
+                            QVariantMap panelMap = panel.toMap();
+                            nanoleaf_->setPanelColor(panelMap.value("id").toInt(),
+                                                     QColor(panelMap.value("color").toString()));
+                        }
+                    }
                     if (!state.isEmpty()) {
-                        qDebug() << "Detected unsupported state properties " << state.keys() << " for Nanoleaf " << name
-                                 << " in step " << stepNumber << " when processing scene: " << scene;
+                        qCWarning(lcHub) << "Detected unsupported state properties " << state.keys()
+                                         << " for Nanoleaf " << name << " in step " << stepNumber
+                                         << " when processing scene: " << scene;
                     }
                 } else {
-                    qDebug() << "Encountered unknown Nanoleaf name " << name << " in step " << stepNumber
-                             << " when processing scene: " << scene;
+                    qCWarning(lcHub) << "Encountered unknown Nanoleaf name " << name << " in step " << stepNumber
+                                     << " when processing scene: " << scene;
                 }
             } else {
-                qDebug() << "Encountered unsupported class " << className << " in step " << stepNumber
-                         << " when processing scene: " << scene;
+                qCWarning(lcHub) << "Encountered unsupported class " << className << " in step " << stepNumber
+                                 << " when processing scene: " << scene;
             }
         } else {
-            qDebug() << "Missing device and/or state for step " << stepNumber << " in scene: " << scene;
-        }
-
-        // Insert a brief pause in between steps to prevent overloading the devices.
-        QTime future = QTime::currentTime().addMSecs(200);
-        while (future > QTime::currentTime()) {
-            QCoreApplication::processEvents(QEventLoop::AllEvents, 500);
+            qCWarning(lcHub) << "Missing device and/or state for step " << stepNumber << " in scene: " << scene;
         }
     }
 
-    qDebug() << "Finished processing scene: " << scene;
+    qCInfo(lcHub) << "Finished processing scene: " << scene;
+    metrics.duration->record(sceneClock.nsecsElapsed() / 1000);
     isRunningScene_ = false;
     emit isRunningSceneChanged();
 }
@@ -328,30 +411,30 @@ QString VCHub::dayOfWeek(const QDateTime& dateTime) const {
 /*--------------------------------------------------------------------------------------------------------------------*/
 
 QString VCHub::formatTime(const QDateTime& dateTime) const {
-    return dateTime.toString(use24HourClock() ? "hh:mm" : "h:mm AP");
+    return TimeFormatter::instance()->time(dateTime);
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
 
 QString VCHub::formatInt(int value, const QString& unit) const {
-    QString display = QLocale::system().toString(value);
+    QString display = NumberFormatter::instance()->integer(value);
     if (!unit.isEmpty()) {
-        display.append(QString(" %1").arg(unit));
+        display.append(' ').append(unit);
     }
     return display;
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
 
-QString VCHub::formatDecimal(double dValue, const QString& Unit) const {
-    QString Display = QLocale::system().toString(dValue, 'f', 1);  // 1 decimal place
-    if (!Unit.isEmpty()) {
-        Display.append(QString(" %1").arg(Unit));
+QString VCHub::formatDecimal(double value, const QString& unit) const {
+    QString display = NumberFormatter::instance()->decimal(value, 1);  // 1 decimal place
+    if (!unit.isEmpty()) {
+        display.append(' ').append(unit);
     }
-    return Display;
+    return display;
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
 
 QString VCHub::formatPercentage(double value, bool wholeNumber) const {
-    return QString("%1%").arg(QLocale::system().toString(value, 'f', wholeNumber ? 0 : 1));
+    return NumberFormatter::instance()->percentage(value, wholeNumber);
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
 
@@ -365,10 +448,22 @@ QString VCHub::screenshotPath() const {
 void VCHub::updateCurrentDateTime() {
     currentDateTime_ = QDateTime::currentDateTime();
     emit currentDateTimeChanged();
+
+    // Line back up with the next minute, which also corrects for the clock being changed.
+    scheduleCurrentDateTimeRefresh();
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void VCHub::scheduleCurrentDateTimeRefresh() {
+    int elapsed = QTime::currentTime().msecsSinceStartOfDay() % MINUTE;
+    currentDateTimeRefreshTimer_.start(MINUTE - elapsed);
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
 
 void VCHub::refreshIPAddresses() {
+    QString ethernetIPAddress;
+    QString wifiIPAddress;
+
     // Examine all of the system network interfaces and any associated IP addresses they may have.
     const QList<QNetworkInterface> interfaces = QNetworkInterface::allInterfaces();
     for (const auto& interface : interfaces) {
@@ -378,18 +473,25 @@ void VCHub::refreshIPAddresses() {
             for (const auto& addressEntry : addressEntries) {
                 QHostAddress address = addressEntry.ip();
                 if ((address.protocol() == QAbstractSocket::IPv4Protocol) && !address.isLoopback()) {
-                    QString ipAddress = address.toString();
-                    if ((interface.type() == QNetworkInterface::Ethernet) && (ethernetIPAddress_ != ipAddress)) {
-                        ethernetIPAddress_ = ipAddress;
-                        emit ethernetIPAddressChanged();
-                    } else if ((interface.type() == QNetworkInterface::Wifi) && (ethernetIPAddress_ != ipAddress)) {
-                        wifiIPAddress_ = ipAddress;
-                        emit wifiIPAddressChanged();
+                    if (interface.type() == QNetworkInterface::Ethernet) {
+                        ethernetIPAddress = address.toString();
+                    } else {
+                        wifiIPAddress = address.toString();
                     }
                 }
             }
         }
     }
+
+    // Addresses that went away are cleared, now that changes are picked up as they happen.
+    if (ethernetIPAddress_ != ethernetIPAddress) {
+        ethernetIPAddress_ = ethernetIPAddress;
+        emit ethernetIPAddressChanged();
+    }
+    if (wifiIPAddress_ != wifiIPAddress) {
+        wifiIPAddress_ = wifiIPAddress;
+        emit wifiIPAddressChanged();
+    }
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
 
@@ -410,6 +512,32 @@ QVariantList VCHub::extractSceneSteps(const QString& scene) {
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
 
+VCHub::SceneMetrics VCHub::sceneMetrics(const QString& scene) {
+    auto it = sceneMetrics_.constFind(scene);
+    if (it != sceneMetrics_.constEnd()) {
+        return *it;
+    }
+
+    Metrics* metrics = Metrics::instance();
+    SceneMetrics entry{
+        metrics->counter("vc_scenes_run_total", "Scenes run.", {{"scene", scene}}),
+        metrics->histogram(
+            "vc_scene_duration_seconds", "Time taken to run a scene, including pauses.", {{"scene", scene}})};
+    sceneMetrics_.insert(scene, entry);
+    return entry;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+Metrics::Counter* VCHub::sceneStepCount(const QString& className) {
+    Metrics::Counter* counter = sceneStepCounts_.value(className);
+    if (!counter) {
+        counter = Metrics::instance()->counter("vc_scene_steps_total", "Scene steps executed.", {{"class", className}});
+        sceneStepCounts_.insert(className, counter);
+    }
+    return counter;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
 QObject* vchub_singletontype_provider(QQmlEngine* engine, QJSEngine* scriptEngine) {
     (void)engine;
     (void)scriptEngine;
@@ -2,12 +2,16 @@
 #define VCHUB_H_
 
 #include <QDateTime>
-#ifdef QT_DEBUG
 #include <QFileSystemWatcher>
-#endif
+#include <QHash>
 #include <QQmlEngine>
 #include <QTimer>
 
+#include "addressmonitor.h"
+#include "memorymonitor.h"
+#include "metrics.h"
+#include "profiler.h"
+#include "timeformatter.h"
 #include "vcfacts.h"
 #include "vchue.h"
 #include "vcnanoleaf.h"
@@ -36,6 +40,8 @@ class VCHub final : public QObject {
     Q_PROPERTY(VCWeather * weather                                    READ weather                                      CONSTANT)
     Q_PROPERTY(VCFacts * facts                                        READ facts                                        CONSTANT)
     Q_PROPERTY(VCSpotify * spotify                                    READ spotify                                      CONSTANT)
+    Q_PROPERTY(Profiler * profiler                                    READ profiler                                     CONSTANT)
+    Q_PROPERTY(MemoryMonitor * memoryMonitor                          READ memoryMonitor                                CONSTANT)
     Q_PROPERTY(QVariantList scenes        MEMBER scenes_              READ scenes                                       NOTIFY scenesChanged)
     Q_PROPERTY(QString homeMap            MEMBER homeMap_             READ homeMap                                      NOTIFY homeMapChanged)
     Q_PROPERTY(bool isRunningScene                                    READ isRunningScene                               NOTIFY isRunningSceneChanged)
@@ -53,7 +59,7 @@ class VCHub final : public QObject {
     const QString& platform() const { return platform_; }
     const QString& architecture() const { return architecture_; }
     const QString& qtVersion() const { return qtVersion_; }
-    bool use24HourClock() const { return use24HourClock_; }
+    bool use24HourClock() const { return TimeFormatter::instance()->use24HourClock(); }
     void setUse24HourClock(bool value);
     bool darkerBackground() const { return darkerBackground_; }
     bool screensaverEnabled() const { return screensaverEnabled_; }
@@ -63,6 +69,9 @@ class VCHub final : public QObject {
     VCFacts* facts() const { return facts_; }
     VCWeather* weather() const { return weather_; }
     VCSpotify* spotify() const { return spotify_; }
+    QList<VCPlugin*> plugins() const { return {hue_, nanoleaf_, pihole_, weather_, facts_, spotify_}; }
+    Profiler* profiler() const { return Profiler::instance(); }
+    MemoryMonitor* memoryMonitor() const { return MemoryMonitor::instance(); }
     const QVariantList& scenes() const { return scenes_; }
     const QString& homeMap() const { return homeMap_; }
     bool isRunningScene() const { return isRunningScene_; }
@@ -94,22 +103,29 @@ class VCHub final : public QObject {
 
  private slots:
     void updateCurrentDateTime();
+    void scheduleCurrentDateTimeRefresh();
     void refreshIPAddresses();
+    void reloadConfig();
 
  private:
+    struct SceneMetrics {
+        Metrics::Counter* runs;
+        Metrics::Histogram* duration;
+    };
+
     explicit VCHub(QObject* parent = nullptr);
 
     bool isActive_;
     QDateTime currentDateTime_;
-    QTimer currentDateTimeRefreshTimer_;
+    QTimer currentDateTimeRefreshTimer_;  // Fires on minute boundaries
     QString ethernetIPAddress_;
     QString wifiIPAddress_;
-    QTimer ipAddressesRefreshTimer_;
+    AddressMonitor* addressMonitor_;
+    QTimer ipAddressesRefreshTimer_;  // Only when the address monitor is not available
     QString hostname_;
     QString platform_;
     QString architecture_;
     QString qtVersion_;
-    bool use24HourClock_;
     bool darkerBackground_;
     bool screensaverEnabled_;
     VCHue* hue_;
@@ -121,11 +137,15 @@ class VCHub final : public QObject {
     QVariantList scenes_;
     QString homeMap_;
     bool isRunningScene_;
-#ifdef QT_DEBUG
+    QString configPath_;
     QFileSystemWatcher configFileWatcher_;
-#endif
+    QTimer configReloadTimer_;
+    QHash<QString, SceneMetrics> sceneMetrics_;         // Key: scene
+    QHash<QString, Metrics::Counter*> sceneStepCounts_;  // Key: device class
 
     QVariantList extractSceneSteps(const QString& scene);
+    SceneMetrics sceneMetrics(const QString& scene);
+    Metrics::Counter* sceneStepCount(const QString& className);
 
     Q_DISABLE_COPY_MOVE(VCHub)
 };
@@ -5,6 +5,8 @@
 #include "hueambiancelight.h"
 #include "huecolorlight.h"
 #include "huelight.h"
+#include "logging.h"
+#include "memorymonitor.h"
 #include "networkinterface.h"
 /*--------------------------------------------------------------------------------------------------------------------*/
 
@@ -31,6 +33,10 @@ VCHue::VCHue(const QString& name, QObject* parent) : VCPlugin(name, parent) {
 
     // Look for the Bridge.
     NetworkInterface::instance()->browseZeroConf(HUE_SERVICE_TYPE);
+
+    // Devices are only ever added as the Bridge reports them, so make sure that stays bounded.
+    MemoryMonitor::instance()->watchSize("Hue devices", [this] { return devices_.size(); });
+    MemoryMonitor::instance()->watchSize("Hue device table", [this] { return deviceTable_.size(); });
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
 
@@ -50,7 +56,7 @@ int VCHue::onDevicesCount() const {
 void VCHue::commandDeviceState(const int id, const QJsonObject& parameters) {
     HueDevice* device = deviceTable_.value(id, nullptr);
     if (!device) {
-        qDebug() << "Ignoring request to command state of unknown device: " << id;
+        qCWarning(lcHue) << "Ignoring request to command state of unknown device: " << id;
         return;
     }
 
@@ -73,7 +79,7 @@ void VCHue::refreshGroups() {
 void VCHue::handleZeroConfServiceFound(const QString& serviceType, const QString& ipAddress) {
     if (bridgeIPAddress_.isEmpty() && serviceType.startsWith(HUE_SERVICE_TYPE)) {
         bridgeIPAddress_ = ipAddress;
-        qDebug() << "Hue Bridge found at IP address: " << bridgeIPAddress_;
+        qCInfo(lcHue) << "Hue Bridge found at IP address: " << bridgeIPAddress_;
         emit bridgeIPAddressChanged();
     }
 }
@@ -150,24 +156,25 @@ void VCHue::handleNetworkReply(int statusCode, QObject* sender, const QJsonDocum
                                                 // No record of the device, try again next time.
                                             }
                                         } else {
-                                            qDebug() << "Got invalid light ID in groups response from Hue Bridge";
+                                            qCWarning(lcHue)
+                                                << "Got invalid light ID in groups response from Hue Bridge";
                                         }
                                     }
                                 }
                             }
                         } else {
-                            qDebug() << "Got empty or invalid item object in query response from Hue Bridge at key: "
-                                     << key;
+                            qCWarning(lcHue)
+                                << "Got empty or invalid item object in query response from Hue Bridge at key: " << key;
                         }
                     } else {
-                        qDebug() << "Got invalid ID in query response from Hue Bridge";
+                        qCWarning(lcHue) << "Got invalid ID in query response from Hue Bridge";
                     }
                 }
             } else {
-                qDebug() << "Failed to parse query response from Hue Bridge";
+                qCWarning(lcHue) << "Failed to parse query response from Hue Bridge";
             }
         } else {
-            qDebug() << "Ignoring unsuccessful reply from Hue Bridge with status code: " << statusCode;
+            qCWarning(lcHue) << "Ignoring unsuccessful reply from Hue Bridge with status code: " << statusCode;
         }
     } else {
         auto device = qobject_cast<HueDevice*>(sender);
@@ -176,8 +183,9 @@ void VCHue::handleNetworkReply(int statusCode, QObject* sender, const QJsonDocum
                 // Dispatch to the device.
                 device->handleResponse(body);
             } else {
-                qDebug() << "Ignoring unsuccessful reply from Hue Bridge for device " << device->name()
-                         << " with status code: " << statusCode;
+                qCWarning(lcHue) << "Ignoring unsuccessful reply from Hue Bridge for device " << device->name()
+                                 << " with status code: " << statusCode;
+                device->commands()->rejectAll();
             }
         } else {
             // Not for us, ignore.
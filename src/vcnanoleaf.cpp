@@ -1,9 +1,11 @@
 #include "vcnanoleaf.h"
 
-#include <QColor>
+#include <QDir>
 #include <QJsonArray>
 #include <QJsonObject>
+#include <QStandardPaths>
 
+#include "logging.h"
 #include "networkinterface.h"
 /*--------------------------------------------------------------------------------------------------------------------*/
 
@@ -13,10 +15,18 @@ constexpr const char* NANOLEAF_SERVICE_TYPE = "_nanoleafapi._tcp";
 /*--------------------------------------------------------------------------------------------------------------------*/
 
 VCNanoleaf::VCNanoleaf(const QString& name, QObject* parent)
-    : VCPlugin(name, parent), isOn_(false), commandedPower_(-1) {
+    : VCPlugin(name, parent),
+      isOn_(false),
+      effects_(new NanoleafEffects(this)),
+      commands_(new CommandTracker(this)),
+      layout_(new NanoleafLayout(this)),
+      stream_(new NanoleafStream(this)),
+      isStreaming_(false),
+      effectsRequester_(new QObject(this)) {
     // Don't start refreshing until the Nanoleaf has been found.
     updateTimer_.stop();
     setUpdateInterval(3 * 1000);
+    effectsRequester_->setObjectName(pluginName_);
 
     // Handle network responses.
     connect(NetworkInterface::instance(),
@@ -25,10 +35,29 @@ VCNanoleaf::VCNanoleaf(const QString& name, QObject* parent)
             &VCNanoleaf::handleZeroConfServiceFound);
     connect(NetworkInterface::instance(), &NetworkInterface::jsonReplyReceived, this, &VCNanoleaf::handleNetworkReply);
 
+    // Ask for the catalog again on the next refresh if it could not be had, including when there was no reply at all.
+    connect(NetworkInterface::instance(),
+            &NetworkInterface::replyReceived,
+            this,
+            [this](const int statusCode, QObject* const sender, const QByteArray& body) {
+                (void)body;
+                if ((sender == effectsRequester_) && (statusCode != 200)) {
+                    requestedEffectsList_.clear();
+                }
+            });
+
     // Update the base URL whenever dependent properties change.
     connect(this, &VCNanoleaf::ipAddressChanged, this, &VCNanoleaf::updateBaseURL);
     connect(this, &VCNanoleaf::authTokenChanged, this, &VCNanoleaf::updateBaseURL);
 
+    // Show the palette of the running effect across the panels when not streaming.
+    connect(this, &VCNanoleaf::selectedEffectChanged, this, &VCNanoleaf::updatePanelColors);
+    connect(effects_, &NanoleafEffects::modelReset, this, &VCNanoleaf::updatePanelColors);
+    connect(layout_, &NanoleafLayout::modelReset, this, &VCNanoleaf::updatePanelColors);
+
+    // Start from the effects seen last time.
+    (void)effects_->load(effectsCachePath());
+
     // Look for the Nanoleaf.
     NetworkInterface::instance()->browseZeroConf(NANOLEAF_SERVICE_TYPE);
 }
@@ -40,30 +69,86 @@ void VCNanoleaf::refresh() {
 /*--------------------------------------------------------------------------------------------------------------------*/
 
 void VCNanoleaf::commandPower(const bool on) {
-    QJsonObject command{{"on", QJsonObject{{"value", on}}}};
-    QUrl destination(QString("%1/state").arg(baseURL_));
-
     // Assume the command will succeed.
-    commandedPower_ = on ? 1 : 0;
     isOn_ = on;
     emit isOnChanged();
 
-    NetworkInterface::instance()->sendJSONRequest(
-        destination, this, QNetworkAccessManager::PutOperation, QJsonDocument(command));
+    // Commands may need more than one try if the Nanoleaf has been sitting idle for a while, so keep sending until
+    // the reported state agrees, within reason.
+    commands_->track("on", on, [this, on] { sendPower(on); });
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
 
 void VCNanoleaf::selectEffect(const QString& effect) {
-    QJsonObject command{{"select", effect}};
-    QUrl destination(QString("%1/effects").arg(baseURL_));
+    // An effect takes over from streamed colors, without going back to the one running before.
+    if (isStreaming_) {
+        effectBeforeStreaming_.clear();
+        stopStreaming();
+    }
 
     // Assume the command will succeed.
-    commandedEffect_ = effect;
     selectedEffect_ = effect;
     emit selectedEffectChanged();
 
+    commands_->track("select", effect, [this, effect] { sendEffect(effect); });
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void VCNanoleaf::setStreamFrameRate(const int value) {
+    if (stream_->frameRate() != value) {
+        stream_->setFrameRate(value);
+        emit streamFrameRateChanged();
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void VCNanoleaf::startStreaming() {
+    if (baseURL_.isEmpty() || isStreaming_) {
+        qCWarning(lcNanoleaf) << "Ignoring request to start streaming to Nanoleaf";
+        return;
+    }
+
+    // Switch the Nanoleaf into external control mode, after which it listens for frames over UDP.
+    QJsonObject write{{"command", "display"}, {"animType", "extControl"}, {"extControlVersion", "v2"}};
+    QUrl destination(QString("%1/effects").arg(baseURL_));
     NetworkInterface::instance()->sendJSONRequest(
-        destination, this, QNetworkAccessManager::PutOperation, QJsonDocument(command));
+        destination, this, QNetworkAccessManager::PutOperation, QJsonDocument(QJsonObject{{"write", write}}));
+
+    effectBeforeStreaming_ = selectedEffect_;
+    stream_->setDestination(QHostAddress(ipAddress_));
+    stream_->start();
+    isStreaming_ = true;
+    emit isStreamingChanged();
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void VCNanoleaf::stopStreaming() {
+    if (!isStreaming_) {
+        return;
+    }
+
+    stream_->stop();
+    isStreaming_ = false;
+    emit isStreamingChanged();
+
+    // Go back to whatever was running before.
+    if (!effectBeforeStreaming_.isEmpty()) {
+        selectEffect(effectBeforeStreaming_);
+        effectBeforeStreaming_.clear();
+    }
+    updatePanelColors();
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void VCNanoleaf::setPanelColor(const int panelID, const QColor& color) {
+    if (!color.isValid()) {
+        qCWarning(lcNanoleaf) << "Ignoring request to set invalid color for Nanoleaf panel: " << panelID;
+        return;
+    }
+
+    // The frame buffer is sent out at the stream's frame rate, so this can be called as often as needed.
+    stream_->setPanelColor(panelID, color);
+    layout_->setPanelColor(panelID, color);
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
 
@@ -74,21 +159,21 @@ void VCNanoleaf::refreshEffects() {
 
     // BDP: A put request containing a command to the write endpoint is actually just a query? Really?
     NetworkInterface::instance()->sendJSONRequest(
-        destination, this, QNetworkAccessManager::PutOperation, QJsonDocument(body));
+        destination, effectsRequester_, QNetworkAccessManager::PutOperation, QJsonDocument(body));
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
 
 void VCNanoleaf::handleZeroConfServiceFound(const QString& serviceType, const QString& ipAddress) {
     if (ipAddress_.isEmpty() && serviceType.startsWith(NANOLEAF_SERVICE_TYPE)) {
         ipAddress_ = ipAddress;
-        qDebug() << "Nanoleaf found at IP address: " << ipAddress_;
+        qCInfo(lcNanoleaf) << "Nanoleaf found at IP address: " << ipAddress_;
         emit ipAddressChanged();
     }
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
 
 void VCNanoleaf::handleNetworkReply(int statusCode, QObject* sender, const QJsonDocument& body) {
-    if (sender != this) {
+    if ((sender != this) && (sender != effectsRequester_)) {
         // Not for us, ignore.
         return;
     }
@@ -97,11 +182,11 @@ void VCNanoleaf::handleNetworkReply(int statusCode, QObject* sender, const QJson
         return;
     }
     if (statusCode != 200) {
-        qDebug() << "Ignoring unsuccessful reply from Nanoleaf with status code: " << statusCode;
+        qCWarning(lcNanoleaf) << "Ignoring unsuccessful reply from Nanoleaf with status code: " << statusCode;
         return;
     }
     if (!body.isObject()) {
-        qDebug() << "Failed to parse response from Nanoleaf";
+        qCWarning(lcNanoleaf) << "Failed to parse response from Nanoleaf";
         return;
     }
 
@@ -118,22 +203,27 @@ void VCNanoleaf::handleNetworkReply(int statusCode, QObject* sender, const QJson
         if (effectsObject.contains("select")) {
             QString selected = effectsObject.value("select").toString();
 
-            // BDP: Ensure the commanded effect is applied, which seems to possibly take more than one try
-            //      if the Nanoleaf has been sitting idle for a while.
-            if (!commandedEffect_.isEmpty() && (commandedEffect_ != selected)) {
-                // Command the effect again after a short delay.
-                // TODO(BDP): Give up after a certain number of attempts?
-                QTimer::singleShot(500, this, [this] { selectEffect(commandedEffect_); });
-            } else {
-                commandedEffect_.clear();
-
-                if (selectedEffect_ != selected) {
-                    selectedEffect_ = selected;
-                    emit selectedEffectChanged();
-                }
+            // Leave the assumed state in place while a command is still being confirmed.
+            commands_->confirm("select", selected);
+            if (!commands_->isPending("select") && (selectedEffect_ != selected)) {
+                selectedEffect_ = selected;
+                emit selectedEffectChanged();
+            }
+        }
+        if (effectsObject.contains("effectsList")) {
+            // Only ask for the full effect details when the installed effects differ from the catalog.
+            QStringList names = effectsObject.value("effectsList").toVariant().toStringList();
+            if (!effects_->matches(names) && (requestedEffectsList_ != names)) {
+                requestedEffectsList_ = names;
+                refreshEffects();
             }
         }
     }
+    if (responseObject.contains("panelLayout")) {
+        QJsonObject panelLayoutObject = responseObject.value("panelLayout").toObject();
+        double globalOrientation = panelLayoutObject.value("globalOrientation").toObject().value("value").toDouble();
+        layout_->update(panelLayoutObject.value("layout").toObject(), globalOrientation);
+    }
     if (responseObject.contains("state")) {
         QJsonObject stateObject = responseObject.value("state").toObject();
         if (stateObject.contains("on")) {
@@ -141,68 +231,18 @@ void VCNanoleaf::handleNetworkReply(int statusCode, QObject* sender, const QJson
             if (onObject.contains("value")) {
                 bool on = onObject.value("value").toBool();
 
-                // BDP: Ensure the commanded power is applied.
-                if (((commandedPower_ == 0) && on) || ((commandedPower_ == 1) && !on)) {
-                    // Command again after a short delay.
-                    QTimer::singleShot(500, this, [this] { commandPower(commandedPower_ == 1); });
-                } else {
-                    commandedPower_ = -1;
-
-                    if (isOn_ != on) {
-                        isOn_ = on;
-                        emit isOnChanged();
-                    }
+                commands_->confirm("on", on);
+                if (!commands_->isPending("on") && (isOn_ != on)) {
+                    isOn_ = on;
+                    emit isOnChanged();
                 }
             }
         }
     }
     if (responseObject.contains("animations")) {
-        QVariantList effects;
-        const QJsonArray animationsArray = responseObject.value("animations").toArray();
-        for (const auto& animation : animationsArray) {
-            QJsonObject animationObject = animation.toObject();
-            if (!animationObject.isEmpty()) {
-                QVariantMap effect{{"name", animationObject.value("animName").toString()}};
-
-                QStringList colors;
-                const QJsonArray paletteArray = animationObject.value("palette").toArray();
-                for (const auto& palette : paletteArray) {
-                    QJsonObject paletteObject = palette.toObject();
-                    if (!paletteObject.isEmpty()) {
-                        double hue = paletteObject.value("hue").toInt() / 359.0;
-                        double saturation = paletteObject.value("saturation").toInt() / 100.0;
-                        double brightness = paletteObject.value("brightness").toInt() / 100.0;
-                        colors.append(QColor::fromHsvF(hue, saturation, brightness).name());
-                    }
-                }
-                effect["colors"] = colors;
-
-                const QJsonArray optionsArray = animationObject.value("pluginOptions").toArray();
-                for (const auto& option : optionsArray) {
-                    QJsonObject optionObject = option.toObject();
-                    if (!optionObject.isEmpty()) {
-                        QString optionName = optionObject.value("name").toString();
-                        if ((optionName == "delayTime") || (optionName == "transTime")) {
-                            // These values are presented in tenths of a second, convert.
-                            effect[optionName] = optionObject.value("value").toInt() / 10.0;
-                        }
-                    }
-                }
-
-                effects.append(effect);
-            }
-        }
-
-        if (!effects.isEmpty()) {
-            // Sort alphabetically by name.
-            std::sort(effects.begin(), effects.end(), [](const QVariant& left, const QVariant& right) {
-                return left.toMap().value("name").toString() < right.toMap().value("name").toString();
-            });
-
-            if (effects_ != effects) {
-                effects_ = effects;
-                emit effectsChanged();
-            }
+        // Full effect details, only parsed when they differ from the catalog.
+        if (effects_->update(responseObject.value("animations").toArray())) {
+            (void)effects_->save(effectsCachePath());
         }
     }
 }
@@ -217,8 +257,46 @@ void VCNanoleaf::updateBaseURL() {
     baseURL_ = QString("http://%1:16021/api/v1/%2").arg(ipAddress_, authToken_);
 
     // With the IP address known, start the update timer and refesh immediately.
+    // The effects catalog is cached, so it is only refreshed if the state reports a different set of effects.
     updateTimer_.start();
     refresh();
-    refreshEffects();
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void VCNanoleaf::sendPower(const bool on) {
+    QJsonObject command{{"on", QJsonObject{{"value", on}}}};
+    QUrl destination(QString("%1/state").arg(baseURL_));
+    NetworkInterface::instance()->sendJSONRequest(
+        destination, this, QNetworkAccessManager::PutOperation, QJsonDocument(command));
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void VCNanoleaf::sendEffect(const QString& effect) {
+    QJsonObject command{{"select", effect}};
+    QUrl destination(QString("%1/effects").arg(baseURL_));
+    NetworkInterface::instance()->sendJSONRequest(
+        destination, this, QNetworkAccessManager::PutOperation, QJsonDocument(command));
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+QString VCNanoleaf::effectsCachePath() const {
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).filePath("nanoleaf-effects.json");
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void VCNanoleaf::updatePanelColors() {
+    if (isStreaming_) {
+        // The frame buffer drives the colors.
+        return;
+    }
+
+    // Find the palette of the selected effect.
+    QStringList colors = effects_->colors(selectedEffect_);
+
+    // Spread it across the panels.
+    const QVector<int> panelIDs = layout_->panelIDs();
+    for (int i = 0; i < panelIDs.size(); i++) {
+        layout_->setPanelColor(panelIDs.at(i), colors.isEmpty() ? QColor() : QColor(colors.at(i % colors.size())));
+    }
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
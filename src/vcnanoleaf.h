@@ -1,21 +1,30 @@
 #ifndef VCNANOLEAF_H_
 #define VCNANOLEAF_H_
 
+#include <QColor>
 #include <QVariant>
 
+#include "commandtracker.h"
+#include "nanoleafeffects.h"
+#include "nanoleaflayout.h"
+#include "nanoleafstream.h"
 #include "vcplugin.h"
 
 class VCNanoleaf final : public VCPlugin {
     Q_OBJECT
 
     // clang-format off
-    Q_PROPERTY(QString name                               READ name            NOTIFY nameChanged)
-    Q_PROPERTY(bool isOn                                  READ isOn            NOTIFY isOnChanged)
-    Q_PROPERTY(QVariantList effects                       READ effects         NOTIFY effectsChanged)
-    Q_PROPERTY(QString selectedEffect                     READ selectedEffect  NOTIFY selectedEffectChanged)
-    Q_PROPERTY(QString ipAddress                          READ ipAddress       NOTIFY ipAddressChanged)
-    Q_PROPERTY(QString authToken       MEMBER authToken_                       NOTIFY authTokenChanged)
-    Q_PROPERTY(QVariantList mapPoint   MEMBER mapPoint_                        NOTIFY mapPointChanged)
+    Q_PROPERTY(QString name                               READ name             NOTIFY nameChanged)
+    Q_PROPERTY(bool isOn                                  READ isOn             NOTIFY isOnChanged)
+    Q_PROPERTY(NanoleafEffects * effects                  READ effects          CONSTANT)
+    Q_PROPERTY(QString selectedEffect                     READ selectedEffect   NOTIFY selectedEffectChanged)
+    Q_PROPERTY(QString ipAddress                          READ ipAddress        NOTIFY ipAddressChanged)
+    Q_PROPERTY(QString authToken       MEMBER authToken_                        NOTIFY authTokenChanged)
+    Q_PROPERTY(QVariantList mapPoint   MEMBER mapPoint_                         NOTIFY mapPointChanged)
+    Q_PROPERTY(CommandTracker * commands                  READ commands         CONSTANT)
+    Q_PROPERTY(NanoleafLayout * layout                    READ layout           CONSTANT)
+    Q_PROPERTY(bool isStreaming                           READ isStreaming      NOTIFY isStreamingChanged)
+    Q_PROPERTY(int streamFrameRate     READ streamFrameRate  WRITE setStreamFrameRate  NOTIFY streamFrameRateChanged)
     // clang-format on
 
  public:
@@ -23,21 +32,30 @@ class VCNanoleaf final : public VCPlugin {
 
     const QString& name() const { return name_; }
     bool isOn() const { return isOn_; }
-    const QVariantList& effects() const { return effects_; }
+    NanoleafEffects* effects() const { return effects_; }
     const QString& selectedEffect() const { return selectedEffect_; }
     const QString& ipAddress() const { return ipAddress_; }
+    CommandTracker* commands() const { return commands_; }
+    NanoleafLayout* layout() const { return layout_; }
+    bool isStreaming() const { return isStreaming_; }
+    int streamFrameRate() const { return stream_->frameRate(); }
+    void setStreamFrameRate(int value);
 
     Q_INVOKABLE void commandPower(bool on);
     Q_INVOKABLE void selectEffect(const QString& effect);
+    Q_INVOKABLE void startStreaming();
+    Q_INVOKABLE void stopStreaming();
+    Q_INVOKABLE void setPanelColor(int panelID, const QColor& color);
 
  signals:
     void nameChanged();
     void isOnChanged();
-    void effectsChanged();
     void selectedEffectChanged();
     void ipAddressChanged();
     void authTokenChanged();
     void mapPointChanged();
+    void isStreamingChanged();
+    void streamFrameRateChanged();
 
  public slots:
     void refresh() override;
@@ -47,19 +65,29 @@ class VCNanoleaf final : public VCPlugin {
     void handleZeroConfServiceFound(const QString& serviceType, const QString& ipAddress);
     void handleNetworkReply(int statusCode, QObject* sender, const QJsonDocument& body);
     void updateBaseURL();
+    void updatePanelColors();
 
  private:
     QString name_;
     bool isOn_;
-    int commandedPower_;
-    QVariantList effects_;
+    NanoleafEffects* effects_;
     QString selectedEffect_;
-    QString commandedEffect_;
     QString ipAddress_;
     QString authToken_;
     QVariantList mapPoint_;
 
     QString baseURL_;
+    CommandTracker* commands_;
+    NanoleafLayout* layout_;
+    NanoleafStream* stream_;
+    bool isStreaming_;
+    QString effectBeforeStreaming_;
+    QStringList requestedEffectsList_;  // Installed effects the catalog was last requested for
+    QObject* effectsRequester_;         // Sender of catalog requests, to tell their replies apart
+
+    QString effectsCachePath() const;
+    void sendPower(bool on);
+    void sendEffect(const QString& effect);
 
     Q_DISABLE_COPY_MOVE(VCNanoleaf)
 };
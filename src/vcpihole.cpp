@@ -2,7 +2,9 @@
 
 #include <QJsonObject>
 
+#include "logging.h"
 #include "networkinterface.h"
+#include "numberformatter.h"
 /*--------------------------------------------------------------------------------------------------------------------*/
 
 VCPiHole::VCPiHole(const QString& name, QObject* parent)
@@ -12,7 +14,12 @@ VCPiHole::VCPiHole(const QString& name, QObject* parent)
       totalQueries_(0),
       blockedQueries_(0),
       percentBlocked_(qQNaN()),
-      blockedDomains_(0) {
+      blockedDomains_(0),
+      totalQueriesText_(NumberFormatter::instance()->integer(totalQueries_)),
+      sentQueriesText_(NumberFormatter::instance()->integer(totalQueries_ - blockedQueries_)),
+      blockedQueriesText_(NumberFormatter::instance()->integer(blockedQueries_)),
+      percentBlockedText_(NumberFormatter::instance()->percentage(percentBlocked_)),
+      blockedDomainsText_(NumberFormatter::instance()->integer(blockedDomains_)) {
     // Don't start refreshing until the Pi-hole server has been found.
     updateTimer_.stop();
     setUpdateInterval(1000);
@@ -41,14 +48,14 @@ void VCPiHole::refreshHistoricalData() {
 
 void VCPiHole::handleHostLookup(const QHostInfo& host) {
     if (host.error() != QHostInfo::NoError) {
-        qDebug() << "Failed to find Pi-hole server on the local network with error: " << host.errorString();
+        qCWarning(lcPiHole) << "Failed to find Pi-hole server on the local network with error: " << host.errorString();
     }
 
     const QList<QHostAddress> addresses = host.addresses();
     for (const auto& address : addresses) {
         if (address.protocol() == QAbstractSocket::IPv4Protocol) {
             serverIPAddress_ = address.toString();
-            qDebug() << "Pi-hole server found at IP address: " << serverIPAddress_;
+            qCInfo(lcPiHole) << "Pi-hole server found at IP address: " << serverIPAddress_;
 
             // Update the destination URL and start refreshing information.
             QString baseURL = QString("http://%1:%2/admin/api.php").arg(serverIPAddress_).arg(serverPort_);
@@ -71,11 +78,11 @@ void VCPiHole::handleNetworkReply(int statusCode, QObject* sender, const QJsonDo
         return;
     }
     if (statusCode != 200) {
-        qDebug() << "Ignoring unsuccessful reply from Pi-hole server with status code: " << statusCode;
+        qCWarning(lcPiHole) << "Ignoring unsuccessful reply from Pi-hole server with status code: " << statusCode;
         return;
     }
     if (!body.isObject()) {
-        qDebug() << "Failed to parse response from Pi-hole server";
+        qCWarning(lcPiHole) << "Failed to parse response from Pi-hole server";
         return;
     }
 
@@ -91,6 +98,7 @@ void VCPiHole::handleNetworkReply(int statusCode, QObject* sender, const QJsonDo
         int totalQueries = responseObject.value("dns_queries_today").toInt();
         if (totalQueries_ != totalQueries) {
             totalQueries_ = totalQueries;
+            totalQueriesText_ = NumberFormatter::instance()->integer(totalQueries_);
             emit totalQueriesChanged();
         }
     }
@@ -98,6 +106,7 @@ void VCPiHole::handleNetworkReply(int statusCode, QObject* sender, const QJsonDo
         int blockedQueries = responseObject.value("ads_blocked_today").toInt();
         if (blockedQueries_ != blockedQueries) {
             blockedQueries_ = blockedQueries;
+            blockedQueriesText_ = NumberFormatter::instance()->integer(blockedQueries_);
             emit blockedQueriesChanged();
         }
     }
@@ -106,6 +115,7 @@ void VCPiHole::handleNetworkReply(int statusCode, QObject* sender, const QJsonDo
         double percentBlocked = responseObject.value("ads_percentage_today").toDouble();
         if (percentBlocked_ != percentBlocked) {
             percentBlocked_ = percentBlocked;
+            percentBlockedText_ = NumberFormatter::instance()->percentage(percentBlocked_);
             emit percentBlockedChanged();
         }
     }
@@ -113,9 +123,15 @@ void VCPiHole::handleNetworkReply(int statusCode, QObject* sender, const QJsonDo
         int blockedDomains = responseObject.value("domains_being_blocked").toInt();
         if (blockedDomains_ != blockedDomains) {
             blockedDomains_ = blockedDomains;
+            blockedDomainsText_ = NumberFormatter::instance()->integer(blockedDomains_);
             emit blockedDomainsChanged();
         }
     }
+    QString sentQueriesText = NumberFormatter::instance()->integer(totalQueries_ - blockedQueries_);
+    if (sentQueriesText_ != sentQueriesText) {
+        sentQueriesText_ = sentQueriesText;
+        emit sentQueriesTextChanged();
+    }
     if (responseObject.contains("domains_over_time") && responseObject.contains("ads_over_time")) {
         QJsonObject domainsOverTime = responseObject.value("domains_over_time").toObject();
         QJsonObject adsOverTime = responseObject.value("ads_over_time").toObject();
@@ -10,15 +10,20 @@ class VCPiHole final : public VCPlugin {
     Q_OBJECT
 
     // clang-format off
-    Q_PROPERTY(QString serverHostname      MEMBER serverHostname_  READ serverHostname   NOTIFY serverHostnameChanged)
-    Q_PROPERTY(quint16 serverPort          MEMBER serverPort_      READ serverPort       NOTIFY serverPortChanged )
-    Q_PROPERTY(QString serverIPAddress                             READ serverIPAddress  NOTIFY serverIPAddressChanged)
-    Q_PROPERTY(bool isEnabled                                      READ isEnabled        NOTIFY isEnabledChanged)
-    Q_PROPERTY(int totalQueries                                    READ totalQueries     NOTIFY totalQueriesChanged)
-    Q_PROPERTY(int blockedQueries                                  READ blockedQueries   NOTIFY blockedQueriesChanged)
-    Q_PROPERTY(double percentBlocked                               READ percentBlocked   NOTIFY percentBlockedChanged)
-    Q_PROPERTY(int blockedDomains                                  READ blockedDomains   NOTIFY blockedDomainsChanged)
-    Q_PROPERTY(QVariantMap historicalData                          READ historicalData   NOTIFY historicalDataChanged)
+    Q_PROPERTY(QString serverHostname      MEMBER serverHostname_  READ serverHostname      NOTIFY serverHostnameChanged)
+    Q_PROPERTY(quint16 serverPort          MEMBER serverPort_      READ serverPort          NOTIFY serverPortChanged)
+    Q_PROPERTY(QString serverIPAddress                             READ serverIPAddress     NOTIFY serverIPAddressChanged)
+    Q_PROPERTY(bool isEnabled                                      READ isEnabled           NOTIFY isEnabledChanged)
+    Q_PROPERTY(int totalQueries                                    READ totalQueries        NOTIFY totalQueriesChanged)
+    Q_PROPERTY(int blockedQueries                                  READ blockedQueries      NOTIFY blockedQueriesChanged)
+    Q_PROPERTY(double percentBlocked                               READ percentBlocked      NOTIFY percentBlockedChanged)
+    Q_PROPERTY(int blockedDomains                                  READ blockedDomains      NOTIFY blockedDomainsChanged)
+    Q_PROPERTY(QString totalQueriesText                            READ totalQueriesText    NOTIFY totalQueriesChanged)
+    Q_PROPERTY(QString sentQueriesText                             READ sentQueriesText     NOTIFY sentQueriesTextChanged)
+    Q_PROPERTY(QString blockedQueriesText                          READ blockedQueriesText  NOTIFY blockedQueriesChanged)
+    Q_PROPERTY(QString percentBlockedText                          READ percentBlockedText  NOTIFY percentBlockedChanged)
+    Q_PROPERTY(QString blockedDomainsText                          READ blockedDomainsText  NOTIFY blockedDomainsChanged)
+    Q_PROPERTY(QVariantMap historicalData                          READ historicalData      NOTIFY historicalDataChanged)
     // clang-format on
 
  public:
@@ -33,6 +38,11 @@ class VCPiHole final : public VCPlugin {
     double percentBlocked() const { return percentBlocked_; }
     int blockedDomains() const { return blockedDomains_; }
     const QVariantMap& historicalData() const { return historicalData_; }
+    const QString& totalQueriesText() const { return totalQueriesText_; }
+    const QString& sentQueriesText() const { return sentQueriesText_; }
+    const QString& blockedQueriesText() const { return blockedQueriesText_; }
+    const QString& percentBlockedText() const { return percentBlockedText_; }
+    const QString& blockedDomainsText() const { return blockedDomainsText_; }
 
  signals:
     void serverHostnameChanged();
@@ -43,6 +53,7 @@ class VCPiHole final : public VCPlugin {
     void blockedQueriesChanged();
     void percentBlockedChanged();
     void blockedDomainsChanged();
+    void sentQueriesTextChanged();
     void historicalDataChanged();
 
  public slots:
@@ -64,6 +75,13 @@ class VCPiHole final : public VCPlugin {
     int blockedDomains_;
     QVariantMap historicalData_;
 
+    // Formatted once when the values change, rather than on every binding evaluation in QML.
+    QString totalQueriesText_;
+    QString sentQueriesText_;
+    QString blockedQueriesText_;
+    QString percentBlockedText_;
+    QString blockedDomainsText_;
+
     QUrl summaryDestination_;
     QUrl historicalDataDestination_;
 
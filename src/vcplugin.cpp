@@ -1,34 +1,60 @@
 #include "vcplugin.h"
 
-#include <QDebug>
+#include <QMetaProperty>
+
+#include "logging.h"
+#include "networkinterface.h"
+#include "profiler.h"
 /*--------------------------------------------------------------------------------------------------------------------*/
 
 VCPlugin::VCPlugin(const QString& name, QObject* parent)
-    : QObject(parent), pluginName_(name), updateInterval_(10 * 1000), isActive_(true) {
+    : QObject(parent),
+      pluginName_(name),
+      updateInterval_(10 * 1000),
+      backgroundUpdateInterval_(60 * 1000),
+      isActive_(true),
+      refreshCounter_(Metrics::instance()->counter(
+          "vc_plugin_refreshes_total", "Periodic plugin refreshes.", {{"plugin", pluginName_}})),
+      stateChangeCounter_(Metrics::instance()->counter(
+          "vc_plugin_state_changes_total", "Plugin property changes.", {{"plugin", pluginName_}})),
+      isReachable_(true) {
     if (pluginName_.isEmpty()) {
         qFatal("Missing name for VCPlugin");
     }
 
     setObjectName(pluginName_);
-    qDebug() << "Initializing plugin: " << pluginName_;
+    qCInfo(lcPlugin) << "Initializing plugin: " << pluginName_;
 
-    // Configure the update timer for periodically refreshing any attached data.
-    updateTimer_.setInterval(updateInterval_);
+    // Configure the update timer for periodically refreshing any attached data, starting in the background until
+    // something shows it.
+    applyUpdateInterval();
     updateTimer_.setSingleShot(false);
-    connect(&updateTimer_, &QTimer::timeout, this, &VCPlugin::refresh);
+    connect(&updateTimer_, &QTimer::timeout, this, &VCPlugin::handleUpdateTimeout);
     updateTimer_.start();
+
+    // Follow whether the hosts the plugin talks to are up, for views to show.
+    connect(NetworkInterface::instance(), &NetworkInterface::circuitStateChanged, this, &VCPlugin::updateReachability);
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
 
 void VCPlugin::setUpdateInterval(const int value) {
     if (updateInterval_ != value) {
         updateInterval_ = value;
-        updateTimer_.setInterval(updateInterval_);
+        applyUpdateInterval();
         emit updateIntervalChanged();
     }
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
 
+void VCPlugin::setBackgroundUpdateInterval(const int value) {
+    if (backgroundUpdateInterval_ != value) {
+        backgroundUpdateInterval_ = value;
+        applyUpdateInterval();
+        emit backgroundUpdateIntervalChanged();
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
 void VCPlugin::setActive(const bool value) {
     if (isActive_ != value) {
         isActive_ = value;
@@ -36,6 +62,8 @@ void VCPlugin::setActive(const bool value) {
 
         if (isActive_) {
             updateTimer_.start();
+            refreshCounter_->increment();
+            lastRefresh_.start();
             refresh();
         } else {
             updateTimer_.stop();
@@ -43,3 +71,80 @@ void VCPlugin::setActive(const bool value) {
     }
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
+
+void VCPlugin::addViewer(QObject* viewer) {
+    if (!viewer || viewers_.contains(viewer)) {
+        return;
+    }
+
+    viewers_.insert(viewer);
+    if (viewers_.size() == 1) {
+        applyUpdateInterval();
+        emit isViewedChanged();
+
+        // Catch up right away if the data went stale while nothing was showing it.
+        refreshIfStale();
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void VCPlugin::removeViewer(QObject* viewer) {
+    if (viewers_.remove(viewer) && viewers_.isEmpty()) {
+        applyUpdateInterval();
+        emit isViewedChanged();
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void VCPlugin::refreshIfStale() {
+    if (updateTimer_.isActive() && (!lastRefresh_.isValid() || lastRefresh_.hasExpired(updateInterval_))) {
+        handleUpdateTimeout();
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void VCPlugin::trackStateChanges() {
+    // This has to happen after construction, when the meta-object includes the properties of the derived class.
+    static const QMetaMethod countMethod =
+        staticMetaObject.method(staticMetaObject.indexOfSlot("countStateChange()"));
+
+    const QMetaObject* meta = metaObject();
+    for (int i = 0; i < meta->propertyCount(); i++) {
+        QMetaProperty property = meta->property(i);
+        if (property.hasNotifySignal()) {
+            connect(this, property.notifySignal(), this, countMethod, Qt::UniqueConnection);
+        }
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void VCPlugin::handleUpdateTimeout() {
+    Profiler::Scope scope("refresh", pluginName_);
+    lastRefresh_.start();
+    refreshCounter_->increment();
+    refresh();
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void VCPlugin::countStateChange() {
+    stateChangeCounter_->increment();
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void VCPlugin::updateReachability() {
+    bool isReachable = NetworkInterface::instance()->isReachable(this);
+    if (isReachable_ != isReachable) {
+        isReachable_ = isReachable;
+        emit isReachableChanged();
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void VCPlugin::applyUpdateInterval() {
+    // Never refresh slower when shown than when not, and changing the interval of a stopped timer leaves it so.
+    int interval = isViewed() ? updateInterval_ : qMax(updateInterval_, backgroundUpdateInterval_);
+    if (updateTimer_.interval() != interval) {
+        updateTimer_.setInterval(interval);
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
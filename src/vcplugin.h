@@ -1,17 +1,24 @@
 #ifndef VCPLUGIN_H_
 #define VCPLUGIN_H_
 
+#include <QElapsedTimer>
 #include <QObject>
+#include <QSet>
 #include <QString>
 #include <QTimer>
 
+#include "metrics.h"
+
 class VCPlugin : public QObject {
     Q_OBJECT
 
     // clang-format off
-    Q_PROPERTY(QString pluginName  READ pluginName                               CONSTANT)
-    Q_PROPERTY(int updateInterval  READ updateInterval  WRITE setUpdateInterval  NOTIFY updateIntervalChanged)
-    Q_PROPERTY(bool isActive       READ isActive        WRITE setActive          NOTIFY isActiveChanged)
+    Q_PROPERTY(QString pluginName            READ pluginName                                                   CONSTANT)
+    Q_PROPERTY(int updateInterval            READ updateInterval            WRITE setUpdateInterval            NOTIFY updateIntervalChanged)
+    Q_PROPERTY(int backgroundUpdateInterval  READ backgroundUpdateInterval  WRITE setBackgroundUpdateInterval  NOTIFY backgroundUpdateIntervalChanged)
+    Q_PROPERTY(bool isActive                 READ isActive                  WRITE setActive                    NOTIFY isActiveChanged)
+    Q_PROPERTY(bool isViewed                 READ isViewed                                                     NOTIFY isViewedChanged)
+    Q_PROPERTY(bool isReachable              READ isReachable                                                  NOTIFY isReachableChanged)
     // clang-format on
 
  public:
@@ -20,12 +27,29 @@ class VCPlugin : public QObject {
     const QString& pluginName() const { return pluginName_; }
     int updateInterval() const { return updateInterval_; }
     void setUpdateInterval(int value);
+    int backgroundUpdateInterval() const { return backgroundUpdateInterval_; }
+    void setBackgroundUpdateInterval(int value);
     bool isActive() const { return isActive_; }
     void setActive(bool value);
+    bool isViewed() const { return !viewers_.isEmpty(); }
+    bool isReachable() const { return isReachable_; }  // Whether the hosts of the plugin are answering
+
+    // Anything showing the data of the plugin registers itself while it is visible, and the plugin drops to the
+    // background update interval while nothing is.
+    void addViewer(QObject* viewer);
+    void removeViewer(QObject* viewer);
+
+    // Refreshes right away unless that already happened within the update interval, or the plugin is idle.
+    void refreshIfStale();
+
+    void trackStateChanges();
 
  signals:
     void updateIntervalChanged();
+    void backgroundUpdateIntervalChanged();
     void isActiveChanged();
+    void isViewedChanged();
+    void isReachableChanged();
 
  public slots:
     virtual void refresh() = 0;
@@ -33,9 +57,24 @@ class VCPlugin : public QObject {
  protected:
     QString pluginName_;
     int updateInterval_;
+    int backgroundUpdateInterval_;
     QTimer updateTimer_;
     bool isActive_;
 
+ private slots:
+    void handleUpdateTimeout();
+    void countStateChange();
+    void updateReachability();
+
+ private:
+    Metrics::Counter* refreshCounter_;
+    Metrics::Counter* stateChangeCounter_;
+    QSet<QObject*> viewers_;
+    QElapsedTimer lastRefresh_;
+    bool isReachable_;
+
+    void applyUpdateInterval();
+
     Q_DISABLE_COPY_MOVE(VCPlugin)
 };
 
@@ -1,14 +1,72 @@
 #include "vcspotify.h"
 
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
 #include <QJsonArray>
 #include <QJsonObject>
+#include <QSaveFile>
+#include <QStandardPaths>
 #include <QUrlQuery>
+#include <limits>
 
+#include "logging.h"
+#include "metrics.h"
 #include "networkinterface.h"
 /*--------------------------------------------------------------------------------------------------------------------*/
 
 namespace {
 constexpr const char* PLAYER_BASE_URL = "https://api.spotify.com/v1/me/player";
+constexpr int MAX_SYNC_CALLS = 3;               // Per cycle
+constexpr int DEFERRED_SYNC_DELAY = 500;        // Milliseconds
+constexpr qint64 CALL_RATE_WINDOW = 60 * 1000;  // Milliseconds
+const char* const SYNC_RESOURCE_NAMES[] = {"playback", "devices", "playlists", "profile"};
+constexpr int PLAYLISTS_PAGE_SIZE = 50;  // The most allowed
+constexpr int SEARCH_PAGE_SIZE = 20;
+constexpr int SEARCH_DELAY = 300;                    // Milliseconds
+constexpr qint64 TOKEN_EXPIRY_MARGIN = 60 * 1000;    // Milliseconds before expiry to refresh
+constexpr int TOKEN_RETRY_DELAY = 30 * 1000;         // Milliseconds
+constexpr qint64 TOKEN_HANDOVER_WINDOW = 10 * 1000;  // Milliseconds
+
+QUrl firstImage(const QJsonObject& object) {
+    // Take the first image, which is the highest resolution.
+    const QJsonArray imagesArray = object.value("images").toArray();
+    return imagesArray.isEmpty() ? QUrl() : QUrl(imagesArray.first().toObject().value("url").toString());
+}
+
+QString joinArtists(const QJsonObject& itemObject) {
+    QString artists;
+    const QJsonArray artistsArray = itemObject.value("artists").toArray();
+    for (const auto& artist : artistsArray) {
+        QString artistName = artist.toObject().value("name").toString();
+        if (!artistName.isEmpty()) {
+            if (!artists.isEmpty()) {
+                artists.append(", ");
+            }
+            artists.append(artistName);
+        }
+    }
+    return artists;
+}
+
+QVariantMap playlistEntry(const QJsonObject& playlistObject) {
+    return {{"name", playlistObject.value("name").toString()},
+            {"uri", playlistObject.value("uri").toString()},
+            {"isPublic", playlistObject.value("public").toBool()},
+            {"trackCount", playlistObject.value("tracks").toObject().value("total").toInt()},
+            {"image", firstImage(playlistObject)}};
+}
+
+QVariantMap trackEntry(const QJsonObject& itemObject) {
+    QJsonObject albumObject = itemObject.value("album").toObject();
+    return {{"name", itemObject.value("name").toString()},
+            {"uri", itemObject.value("uri").toString()},
+            {"artist", joinArtists(itemObject)},
+            {"album", albumObject.value("name").toString()},
+            {"image", firstImage(albumObject)}};
+}
 }  // namespace
 /*--------------------------------------------------------------------------------------------------------------------*/
 
@@ -21,22 +79,27 @@ VCSpotify::VCSpotify(const QString& name, QObject* parent)
       repeatAllEnabled_(false),
       trackPosition_(0),
       trackDuration_(0),
+      playlists_(new SpotifyResults({"name", "uri", "isPublic", "trackCount", "image"}, this)),
       deviceVolume_(0),
-      market_(QLocale::system().name().split('_').last()) {
-    updateTimer_.setInterval(1000);
+      searchResults_(new SpotifyResults({"name", "uri", "artist", "album", "image"}, this)),
+      market_(QLocale::system().name().split('_').last()),
+      tokenRequester_(new QObject(this)) {
+    setUpdateInterval(1000);
     updateTimer_.stop();
+    tokenRequester_->setObjectName(pluginName_);
 
     // Handle network responses.
     connect(NetworkInterface::instance(), &NetworkInterface::jsonReplyReceived, this, &VCSpotify::handleNetworkReply);
+    NetworkInterface::instance()->addKnownHost(QUrl(PLAYER_BASE_URL));
+    NetworkInterface::instance()->addKnownHost(QUrl("https://accounts.spotify.com"));
 
-    // Request the initial access token when we are told what the refresh token is and have the client information.
-    connect(this, &VCSpotify::clientIDChanged, this, &VCSpotify::refreshAccessToken);
-    connect(this, &VCSpotify::clientSecretChanged, this, &VCSpotify::refreshAccessToken);
-    connect(this, &VCSpotify::refreshTokenChanged, this, &VCSpotify::refreshAccessToken);
+    // Get an access token when we are told what the refresh token is and have the client information.
+    connect(this, &VCSpotify::clientIDChanged, this, &VCSpotify::handleCredentialsChanged);
+    connect(this, &VCSpotify::clientSecretChanged, this, &VCSpotify::handleCredentialsChanged);
+    connect(this, &VCSpotify::refreshTokenChanged, this, &VCSpotify::handleCredentialsChanged);
 
-    // Configure a timer to periodically refresh the access token.
-    accessTokenRefreshTimer_.setInterval(59 * 60 * 1000);  // 1 minute less than the standard expiry time
-    accessTokenRefreshTimer_.setSingleShot(false);
+    // Configure a timer to refresh the access token shortly before it expires, which is scheduled with each new one.
+    accessTokenRefreshTimer_.setSingleShot(true);
     connect(&accessTokenRefreshTimer_, &QTimer::timeout, this, &VCSpotify::refreshAccessToken);
 
     // Configure a timer to set the state as idle if a response is not received.
@@ -60,8 +123,44 @@ VCSpotify::VCSpotify(const QString& name, QObject* parent)
     // Configure a timer to use as a reference to hold off processing after submitting an action.
     // BDP: This helps with keeping things responsive until the API reports the updated state, after which if there is
     //      still a disagreement, the properties will update as normal.
-    actionSubmissionTimer_.setInterval(updateTimer_.interval() / 2);
+    actionSubmissionTimer_.setInterval(updateInterval_ / 2);
     actionSubmissionTimer_.setSingleShot(true);
+
+    // Configure how long each kind of data stays fresh. Playback only needs to keep up with the update interval, and
+    // the rest changes rarely enough that the views asking again on every visit can mostly be skipped.
+    syncStates_[PlaybackSync].maxAge = updateInterval_ / 2;
+    syncStates_[DevicesSync].maxAge = 60 * 1000;
+    syncStates_[PlaylistsSync].maxAge = 5 * 60 * 1000;
+    syncStates_[UserProfileSync].maxAge = 30 * 60 * 1000;
+
+    // Send requests for pages of results on their behalf, from their requester so that the replies can be told apart.
+    for (SpotifyResults* results : {playlists_, searchResults_}) {
+        connect(results, &SpotifyResults::pageRequested, this, [this, results](const QUrl& url) {
+            sendRequest(url, QNetworkAccessManager::GetOperation, QJsonDocument(), results->requester());
+        });
+    }
+
+    // Configure a timer to hold off searching until typing pauses.
+    searchTimer_.setInterval(SEARCH_DELAY);
+    searchTimer_.setSingleShot(true);
+    connect(&searchTimer_, &QTimer::timeout, this, [this] {
+        searchResults_->start(QUrl(QString("https://api.spotify.com/v1/search?type=track&market=%1&limit=%2&q=%3")
+                                       .arg(market_)
+                                       .arg(SEARCH_PAGE_SIZE)
+                                       .arg(QString::fromLatin1(QUrl::toPercentEncoding(searchQuery_)))));
+    });
+
+    // Configure a timer to gather requests made together into one sync cycle.
+    syncTimer_.setSingleShot(true);
+    connect(&syncTimer_, &QTimer::timeout, this, &VCSpotify::runSyncCycle);
+
+    // Publish the call rate when metrics are scraped.
+    callClock_.start();
+    Metrics::instance()->addCollector([this] {
+        Metrics::instance()
+            ->gauge("vc_spotify_calls_per_minute", "Spotify API calls made over the last minute.")
+            ->set(callsPerMinute());
+    });
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
 
@@ -70,10 +169,11 @@ void VCSpotify::play(const QString& uri) {
     if (!isPlayerActive_) {
         // Idle, so a device must be specified for playing to start.
         if (!preferredDeviceID_.isEmpty()) {
-            qDebug() << "Spotify playback is not active, so defaulting to playing on device: " << preferredDevice_;
+            qCInfo(lcSpotify) << "Spotify playback is not active, so defaulting to playing on device: "
+                              << preferredDevice_;
             destination.append(QString("?device_id=%1").arg(preferredDeviceID_));
         } else {
-            qDebug() << "Spotify playback is not active, but there is no preferred device URI to start on";
+            qCWarning(lcSpotify) << "Spotify playback is not active, but there is no preferred device URI to start on";
         }
     }
     QJsonDocument body;
@@ -157,13 +257,14 @@ void VCSpotify::commandDeviceVolume(int value) {
 /*--------------------------------------------------------------------------------------------------------------------*/
 
 void VCSpotify::search(const QString& query) {
-    if (!query.isEmpty()) {
-        QUrl destination(QString("https://api.spotify.com/v1/search?type=track&market=%1&limit=20&q=%2")
-                             .arg(market_, QUrl::toPercentEncoding(query)));
-        sendRequest(destination);
-    } else if (!searchResults_.isEmpty()) {
-        searchResults_.clear();
-        emit searchResultsChanged();
+    // Whatever was asked for the query so far is out of date now, so stop waiting on it.
+    searchQuery_ = query;
+    searchResults_->cancel();
+    if (!searchQuery_.isEmpty()) {
+        searchTimer_.start();
+    } else {
+        searchTimer_.stop();
+        searchResults_->clear();
     }
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
@@ -191,96 +292,223 @@ QString VCSpotify::formatDuration(const int value) {
 /*--------------------------------------------------------------------------------------------------------------------*/
 
 void VCSpotify::refresh() {
-    // Refresh current playback information.
-    static QUrl destination(QString("%1?market=%2").arg(PLAYER_BASE_URL, market_));
-    sendRequest(destination);
+    requestSync(PlaybackSync);
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
 
 void VCSpotify::refreshDevices() {
-    if (!accessTokenAuthorization_.isEmpty()) {
-        static QUrl destination(QString("%1/devices").arg(PLAYER_BASE_URL));
-        sendRequest(destination);
-    }
+    // Only asked for when about to pick a device, so get the current list even if the last one is recent.
+    requestSync(DevicesSync, true);
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
 
 void VCSpotify::refreshUserProfile() {
-    if (!accessTokenAuthorization_.isEmpty()) {
-        static QUrl destination("https://api.spotify.com/v1/me");
-        sendRequest(destination);
-    }
+    requestSync(UserProfileSync);
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
 
 void VCSpotify::refreshPlaylists() {
-    if (!accessTokenAuthorization_.isEmpty()) {
-        static QUrl destination("https://api.spotify.com/v1/me/playlists");
-        sendRequest(destination);
+    requestSync(PlaylistsSync);
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void VCSpotify::requestSync(const SyncResource resource, const bool force) {
+    SyncState& state = syncStates_[resource];
+    state.isWanted = true;
+    state.isForced = state.isForced || force;
+
+    // Anything else asked for before returning to the event loop goes in the same cycle.
+    if (!syncTimer_.isActive()) {
+        syncTimer_.start(0);
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void VCSpotify::runSyncCycle() {
+    if (accessTokenAuthorization_.isEmpty()) {
+        // Hold on to what was asked for until there is an access token, which starts a cycle of its own.
+        return;
+    }
+
+    Metrics* metrics = Metrics::instance();
+    int budget = MAX_SYNC_CALLS;
+    int deferredCount = 0;
+    for (int i = 0; i < SyncResourceCount; i++) {
+        SyncState& state = syncStates_[i];
+        if (!state.isWanted) {
+            continue;
+        }
+
+        // Work out whether the data is still good enough without asking again.
+        const char* skipReason = nullptr;
+        if (!state.isForced) {
+            if (state.lastSync.isValid() && !state.lastSync.hasExpired(state.maxAge)) {
+                skipReason = "fresh";
+            } else if ((i == DevicesSync) && isDeviceListCurrent()) {
+                skipReason = "covered";
+            }
+        }
+        if (skipReason) {
+            state.isWanted = false;
+            metrics
+                ->counter("vc_spotify_sync_skips_total",
+                          "Spotify refreshes skipped by sync cycles.",
+                          {{"resource", SYNC_RESOURCE_NAMES[i]}, {"reason", skipReason}})
+                ->increment();
+            continue;
+        }
+        if (budget == 0) {
+            deferredCount++;
+            continue;
+        }
+
+        switch (i) {
+            case PlaybackSync: {
+                static QUrl destination(QString("%1?market=%2").arg(PLAYER_BASE_URL, market_));
+                sendRequest(destination);
+                break;
+            }
+
+            case DevicesSync: {
+                static QUrl destination(QString("%1/devices").arg(PLAYER_BASE_URL));
+                sendRequest(destination);
+                break;
+            }
+
+            case PlaylistsSync: {
+                static QUrl destination(
+                    QString("https://api.spotify.com/v1/me/playlists?limit=%1").arg(PLAYLISTS_PAGE_SIZE));
+                playlists_->start(destination);
+                break;
+            }
+
+            case UserProfileSync: {
+                static QUrl destination("https://api.spotify.com/v1/me");
+                sendRequest(destination);
+                break;
+            }
+
+            default:
+                break;
+        }
+        state.isWanted = false;
+        state.isForced = false;
+        state.lastSync.start();
+        budget--;
+    }
+
+    if (deferredCount > 0) {
+        qCDebug(lcSpotify) << "Spotify sync cycle over budget, deferring " << deferredCount << " refreshes";
+        syncTimer_.start(DEFERRED_SYNC_DELAY);
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+bool VCSpotify::isDeviceListCurrent() const {
+    // The playback reply names the active device, so as long as that is one already listed there is nothing to
+    // learn from fetching the list again.
+    if (activeDeviceID_.isEmpty()) {
+        return false;
+    }
+    for (const auto& device : devices_) {
+        if (device.toMap().value("id").toString() == activeDeviceID_) {
+            return true;
+        }
+    }
+    return false;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void VCSpotify::countCall() {
+    callTimes_.enqueue(callClock_.elapsed());
+    (void)callsPerMinute();
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int VCSpotify::callsPerMinute() {
+    // Let go of calls that have aged out of the window.
+    qint64 now = callClock_.elapsed();
+    while (!callTimes_.isEmpty() && ((now - callTimes_.head()) >= CALL_RATE_WINDOW)) {
+        (void)callTimes_.dequeue();
     }
+    return callTimes_.size();
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
 
 void VCSpotify::handleNetworkReply(int statusCode, QObject* sender, const QJsonDocument& body) {
-    if (sender != this) {
+    if (sender == tokenRequester_) {
+        handleTokenReply(statusCode, body);
+        return;
+    }
+
+    SpotifyResults* results = nullptr;
+    if (sender == playlists_->requester()) {
+        results = playlists_;
+    } else if (sender == searchResults_->requester()) {
+        results = searchResults_;
+    } else if (sender != this) {
         // Not for us, ignore.
         return;
     }
+    if (results && (statusCode != 200)) {
+        // Let the view ask for the page again.
+        results->stopLoading();
+    }
     if (statusCode == 204) {
         // Success with no content in the response, ignore.
         return;
     }
     if (statusCode == 401) {
-        // Access token expired, invalidate the current one, stop making requests, and ask for a new one.
-        qDebug() << "Spotify access token expired, so requesting a new one";
+        if (isRefreshingToken() ||
+            (tokenExchangeTime_.isValid() && !tokenExchangeTime_.hasExpired(TOKEN_HANDOVER_WINDOW))) {
+            // Either a new token is already on the way, or this was sent with the one just replaced. Every request
+            // in flight gets rejected at once, and they should only lead to the one refresh.
+            return;
+        }
+
+        // Access token expired or revoked, hold off on requests until a new one arrives.
+        qCInfo(lcSpotify) << "Spotify access token rejected, so requesting a new one";
         accessTokenAuthorization_.clear();
-        updateTimer_.stop();
-        accessTokenRefreshTimer_.stop();
+
+        // Whatever else was sent with the old token was rejected too, so none of it counts as fresh.
+        for (auto& state : syncStates_) {
+            state.lastSync.invalidate();
+        }
         refreshAccessToken();
         return;
     }
     if (statusCode != 200) {
-        qDebug() << "Ignoring unsuccessful reply from Spotify with status code: " << statusCode;
+        qCWarning(lcSpotify) << "Ignoring unsuccessful reply from Spotify with status code: " << statusCode;
         return;
     }
     if (!body.isObject()) {
-        qDebug() << "Failed to parse reply from Spotify";
+        qCWarning(lcSpotify) << "Failed to parse reply from Spotify";
+        if (results) {
+            results->stopLoading();
+        }
         return;
     }
 
     QJsonObject responseObject = body.object();
 
-    // First, check if this reply contains an updated access token.
-    if (responseObject.contains("access_token")) {
-        accessToken_ = responseObject.value("access_token").toString();
-        accessTokenType_ = responseObject.value("token_type").toString();
-
-        // Ensure the refresh timer interval is still sufficient.
-        int expiresIn = responseObject.value("expires_in").toInt();
-        int interval = (expiresIn - 60) * 1000;
-        if ((interval > 0) && (interval < accessTokenRefreshTimer_.interval())) {
-            // Bump the interval.
-            accessTokenRefreshTimer_.setInterval(interval);
-        } else {
-            // Inside bounds, leave it alone.
+    if (results) {
+        // A page of results, which for searches is kept under the type of item searched for.
+        QJsonObject pageObject =
+            (results == searchResults_) ? responseObject.value("tracks").toObject() : responseObject;
+        QVariantList entries;
+        const QJsonArray itemsArray = pageObject.value("items").toArray();
+        entries.reserve(itemsArray.size());
+        for (const auto& item : itemsArray) {
+            QJsonObject itemObject = item.toObject();
+            if (!itemObject.isEmpty()) {
+                entries.append((results == searchResults_) ? trackEntry(itemObject) : playlistEntry(itemObject));
+            }
         }
+        results->addPage(entries, QUrl(pageObject.value("next").toString()));
+        return;
+    }
 
-        // Update the authorization header to use in requests.
-        accessTokenAuthorization_ = QString("%1 %2").arg(accessTokenType_, accessToken_).toUtf8();
-
-        // Start/restart timers since we just got a fresh access token.
-        updateTimer_.start();
-        accessTokenRefreshTimer_.start();
-
-        // Refresh data right away in case a previous request was rejected.
-        refresh();
-        refreshUserProfile();
-        refreshPlaylists();
-        refreshDevices();
-
-        qDebug() << "Received new access token from Spotify, asking again in "
-                 << (accessTokenRefreshTimer_.interval() / 1000) << " seconds";
-    } else if (responseObject.contains("is_playing")) {
+    if (responseObject.contains("is_playing")) {
         // Playback information.
         // Kick the inactivity timer.
         inactivityTimer_.start();
@@ -298,6 +526,11 @@ void VCSpotify::handleNetworkReply(int statusCode, QObject* sender, const QJsonD
         }
         if (responseObject.contains("device")) {
             QJsonObject deviceObject = responseObject.value("device").toObject();
+            activeDeviceID_ = deviceObject.value("id").toString();
+            if (!isDeviceListCurrent()) {
+                // Playing somewhere not in the list, so the list is out of date.
+                requestSync(DevicesSync);
+            }
             if (deviceObject.contains("name")) {
                 QString deviceName = deviceObject.value("name").toString();
                 if (deviceName_ != deviceName) {
@@ -352,19 +585,23 @@ void VCSpotify::handleNetworkReply(int statusCode, QObject* sender, const QJsonD
             if (contextObject.contains("type") && contextObject.contains("uri")) {
                 QString contextType = contextObject.value("type").toString();
                 if (contextType == "playlist") {
+                    // Request the name of the playlist, only once per playlist rather than with every update.
                     QString uri = contextObject.value("uri").toString();
-                    QString playlistID = uri.split(':').last();
-
-                    // Request the name of the playlist.
-                    QUrl destination(
-                        QString("https://api.spotify.com/v1/playlists/%1?fields=name,uri").arg(playlistID));
-                    sendRequest(destination);
+                    if ((playlistURI_ != uri) || playlistName_.isEmpty()) {
+                        playlistURI_ = uri;
+                        QString playlistID = uri.split(':').last();
+                        QUrl destination(
+                            QString("https://api.spotify.com/v1/playlists/%1?fields=name,uri").arg(playlistID));
+                        sendRequest(destination);
+                    }
                 } else if (!playlistName_.isEmpty()) {
                     // Clear stale context.
+                    playlistURI_.clear();
                     playlistName_.clear();
                     emit playlistNameChanged();
                 }
             } else if (contextObject.isEmpty()) {
+                playlistURI_.clear();
                 playlistName_.clear();
                 emit playlistNameChanged();
             }
@@ -443,95 +680,6 @@ void VCSpotify::handleNetworkReply(int statusCode, QObject* sender, const QJsonD
             playlistName_ = playlistName;
             emit playlistNameChanged();
         }
-    } else if (responseObject.contains("tracks")) {
-        // Search results.
-        QVariantList searchResultsModel;
-        QJsonObject tracksObject = responseObject.value("tracks").toObject();
-        if (tracksObject.contains("items")) {
-            const QJsonArray itemsArray = tracksObject.value("items").toArray();
-            for (const auto& item : itemsArray) {
-                QJsonObject itemObject = item.toObject();
-                if (!itemObject.isEmpty()) {
-                    QVariantMap searchResult{{"name", itemObject.value("name").toString()},
-                                             {"uri", itemObject.value("uri").toString()}};
-                    if (itemObject.contains("artists")) {
-                        const QJsonArray artistsArray = itemObject.value("artists").toArray();
-                        if (!artistsArray.isEmpty()) {
-                            QString trackArtist;
-                            for (const auto& artist : artistsArray) {
-                                QJsonObject artistObject = artist.toObject();
-                                if (artistObject.contains("name")) {
-                                    QString artistName = artistObject.value("name").toString();
-                                    if (!artistName.isEmpty()) {
-                                        if (!trackArtist.isEmpty()) {
-                                            trackArtist.append(", ");
-                                        }
-                                        trackArtist.append(artistName);
-                                    }
-                                }
-                            }
-                            searchResult["artist"] = trackArtist;
-                        }
-                    }
-                    if (itemObject.contains("album")) {
-                        QJsonObject albumObject = itemObject.value("album").toObject();
-                        if (albumObject.contains("name")) {
-                            searchResult["album"] = albumObject.value("name").toString();
-                        }
-                        if (albumObject.contains("images")) {
-                            // Take the first image, which is the highest resolution.
-                            QJsonArray albumImagesArray = albumObject.value("images").toArray();
-                            if (!albumImagesArray.isEmpty()) {
-                                QJsonObject albumImageObject = albumImagesArray.first().toObject();
-                                if (albumImageObject.contains("url")) {
-                                    searchResult["image"] = QUrl(albumImageObject.value("url").toString());
-                                }
-                            }
-                        }
-                    }
-
-                    searchResultsModel.append(searchResult);
-                }
-            }
-        }
-
-        if (searchResults_ != searchResultsModel) {
-            searchResults_ = searchResultsModel;
-            emit searchResultsChanged();
-        }
-    } else if (responseObject.contains("items")) {
-        // Playlists information.
-        QVariantList playlistsModel;
-        const QJsonArray playlistsArray = responseObject.value("items").toArray();
-        for (const auto& playlist : playlistsArray) {
-            QJsonObject playlistObject = playlist.toObject();
-            if (!playlistObject.isEmpty()) {
-                QVariantMap playlistItem{{"name", playlistObject.value("name").toString()},
-                                         {"uri", playlistObject.value("uri").toString()},
-                                         {"isPublic", playlistObject.value("public").toBool()}};
-                if (playlistObject.contains("tracks")) {
-                    QJsonObject tracksObject = playlistObject.value("tracks").toObject();
-                    playlistItem["trackCount"] = tracksObject.value("total").toInt();
-                }
-                if (playlistObject.contains("images")) {
-                    // Take the first image, which is the highest resolution.
-                    QJsonArray imagesArray = playlistObject.value("images").toArray();
-                    if (!imagesArray.isEmpty()) {
-                        QJsonObject imageObject = imagesArray.first().toObject();
-                        if (imageObject.contains("url")) {
-                            playlistItem["image"] = QUrl(imageObject.value("url").toString());
-                        }
-                    }
-                }
-
-                playlistsModel.append(playlistItem);
-            }
-        }
-
-        if (playlists_ != playlistsModel) {
-            playlists_ = playlistsModel;
-            emit playlistsChanged();
-        }
     } else if (responseObject.contains("devices")) {
         // Devices information.
         QVariantList devicesModel;
@@ -547,7 +695,7 @@ void VCSpotify::handleNetworkReply(int statusCode, QObject* sender, const QJsonD
                     // Yes, store its ID.
                     if (preferredDeviceID_ != id) {
                         preferredDeviceID_ = id;
-                        qDebug() << "Received ID of preferred Spotify device: " << preferredDevice_;
+                        qCInfo(lcSpotify) << "Received ID of preferred Spotify device: " << preferredDevice_;
                     }
                 }
 
@@ -608,19 +756,41 @@ void VCSpotify::handleNetworkReply(int statusCode, QObject* sender, const QJsonD
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
 
+void VCSpotify::handleCredentialsChanged() {
+    if (clientID_.isEmpty() || clientSecret_.isEmpty() || refreshToken_.isEmpty()) {
+        // Not enough information to get a token yet.
+        return;
+    }
+
+    // Pick up where the last run left off if its token is still good, and otherwise exchange for a new one.
+    if (!loadTokenCache()) {
+        refreshAccessToken();
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
 void VCSpotify::refreshAccessToken() {
     if (clientID_.isEmpty() || clientSecret_.isEmpty() || refreshToken_.isEmpty()) {
         // Not enough information to make the request.
         return;
     }
+    if (isRefreshingToken()) {
+        // Already on the way.
+        return;
+    }
+
+    // Try again later if this never gets an answer, which a new token replaces with a refresh ahead of its expiry.
+    tokenRequestTime_.start();
+    accessTokenRefreshTimer_.start(TOKEN_RETRY_DELAY);
 
-    qDebug() << "Refreshing Spotify access token";
+    qCInfo(lcSpotify) << "Refreshing Spotify access token";
     static QUrl destination("https://accounts.spotify.com/api/token");
     QUrlQuery query{{"grant_type", "refresh_token"}, {"refresh_token", refreshToken_}};
     QByteArray clientInfo = QString("%1:%2").arg(clientID_, clientSecret_).toUtf8().toBase64();
     QByteArray authorization = clientInfo.prepend("Basic ");
+    countCall();
     NetworkInterface::instance()->sendRequest(destination,
-                                              this,
+                                              tokenRequester_,
                                               QNetworkAccessManager::PostOperation,
                                               query.toString(QUrl::FullyEncoded).toUtf8(),
                                               "application/x-www-form-urlencoded",
@@ -628,9 +798,135 @@ void VCSpotify::refreshAccessToken() {
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
 
+void VCSpotify::handleTokenReply(const int statusCode, const QJsonDocument& body) {
+    tokenRequestTime_.invalidate();
+
+    QJsonObject responseObject = body.object();
+    QString token = responseObject.value("access_token").toString();
+    if ((statusCode != 200) || token.isEmpty()) {
+        qCWarning(lcSpotify) << "Failed to refresh Spotify access token with status code: " << statusCode
+                             << ", trying again in " << (TOKEN_RETRY_DELAY / 1000) << " seconds";
+        accessTokenRefreshTimer_.start(TOKEN_RETRY_DELAY);
+        return;
+    }
+
+    // Note when the token expires rather than how long it lasts, so the cache knows whether it is still good later.
+    int expiresIn = responseObject.value("expires_in").toInt(60 * 60);
+    qint64 expiry = QDateTime::currentMSecsSinceEpoch() + (static_cast<qint64>(expiresIn) * 1000);
+    tokenExchangeTime_.start();
+    applyAccessToken(token, responseObject.value("token_type").toString(), expiry);
+    saveTokenCache(expiry);
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void VCSpotify::applyAccessToken(const QString& token, const QString& type, const qint64 expiry) {
+    accessToken_ = token;
+    accessTokenType_ = type;
+
+    // Update the authorization header to use in requests.
+    accessTokenAuthorization_ = QString("%1 %2").arg(accessTokenType_, accessToken_).toUtf8();
+
+    // Ask for the next one a little ahead of when this one expires.
+    qint64 remaining = expiry - TOKEN_EXPIRY_MARGIN - QDateTime::currentMSecsSinceEpoch();
+    accessTokenRefreshTimer_.start(static_cast<int>(qBound<qint64>(0, remaining, std::numeric_limits<int>::max())));
+
+    // Start the update timer since we just got a fresh access token.
+    updateTimer_.start();
+
+    // Refresh data right away in case a previous request was rejected, leaving out whatever is still fresh.
+    requestSync(PlaybackSync);
+    requestSync(DevicesSync);
+    requestSync(PlaylistsSync);
+    requestSync(UserProfileSync);
+
+    qCInfo(lcSpotify) << "Using Spotify access token, asking again in " << (accessTokenRefreshTimer_.interval() / 1000)
+                      << " seconds";
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+bool VCSpotify::isRefreshingToken() const {
+    // A request turned away by the network interface never gets a reply, so stop waiting after the retry delay.
+    return tokenRequestTime_.isValid() && !tokenRequestTime_.hasExpired(TOKEN_RETRY_DELAY);
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+QByteArray VCSpotify::credentialsHash() const {
+    // A cached token is only good for the credentials it was exchanged with, which are not written out themselves.
+    return QCryptographicHash::hash(QString("%1:%2").arg(clientID_, refreshToken_).toUtf8(),
+                                    QCryptographicHash::Sha256)
+        .toHex();
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+QString VCSpotify::tokenCachePath() const {
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)).filePath("spotify-token.json");
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+bool VCSpotify::loadTokenCache() {
+    QFile file(tokenCachePath());
+    if (!file.open(QIODevice::ReadOnly)) {
+        // Nothing cached yet.
+        return false;
+    }
+
+    QJsonObject cacheObject = QJsonDocument::fromJson(file.readAll()).object();
+    QString token = cacheObject.value("accessToken").toString();
+    qint64 expiry = cacheObject.value("expiry").toVariant().toLongLong();
+    if (token.isEmpty() || (cacheObject.value("credentials").toString().toUtf8() != credentialsHash())) {
+        qCInfo(lcSpotify) << "Ignoring Spotify token cache for other credentials: " << file.fileName();
+        return false;
+    }
+    if ((expiry - TOKEN_EXPIRY_MARGIN) <= QDateTime::currentMSecsSinceEpoch()) {
+        qCInfo(lcSpotify) << "Cached Spotify access token has expired";
+        return false;
+    }
+
+    qCInfo(lcSpotify) << "Loaded cached Spotify access token expiring at: "
+                      << QDateTime::fromMSecsSinceEpoch(expiry).toString(Qt::ISODate);
+    applyAccessToken(token, cacheObject.value("tokenType").toString(), expiry);
+    return true;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void VCSpotify::saveTokenCache(const qint64 expiry) const {
+    QJsonObject cacheObject{{"accessToken", accessToken_},
+                            {"tokenType", accessTokenType_},
+                            {"expiry", expiry},
+                            {"credentials", QString::fromLatin1(credentialsHash())}};
+
+    QString path = tokenCachePath();
+    if (!QDir().mkpath(QFileInfo(path).absolutePath())) {
+        qCWarning(lcSpotify) << "Failed to create directory for Spotify token cache: " << path;
+        return;
+    }
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(lcSpotify) << "Failed to open Spotify token cache: " << path;
+        return;
+    }
+
+    // The token grants access to the account until it expires, so keep it from anyone else on the machine. This
+    // applies to the temporary file, before anything is written to it.
+    if (!file.setPermissions(QFileDevice::ReadOwner | QFileDevice::WriteOwner)) {
+        qCWarning(lcSpotify) << "Failed to restrict permissions of Spotify token cache: " << path;
+        file.cancelWriting();
+        return;
+    }
+    file.write(QJsonDocument(cacheObject).toJson(QJsonDocument::Compact));
+    if (!file.commit()) {
+        qCWarning(lcSpotify) << "Failed to write Spotify token cache: " << path;
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
 void VCSpotify::sendRequest(const QUrl& destination,
                             const QNetworkAccessManager::Operation requestType,
-                            const QJsonDocument& body) {
-    NetworkInterface::instance()->sendJSONRequest(destination, this, requestType, body, accessTokenAuthorization_);
+                            const QJsonDocument& body,
+                            QObject* const sender) {
+    countCall();
+    NetworkInterface::instance()->sendJSONRequest(
+        destination, sender ? sender : this, requestType, body, accessTokenAuthorization_);
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
@@ -2,12 +2,15 @@
 #define VCSPOTIFY_H_
 
 #include <QByteArray>
+#include <QElapsedTimer>
 #include <QJsonDocument>
 #include <QList>
 #include <QNetworkAccessManager>
+#include <QQueue>
 #include <QUrl>
 #include <QVariant>
 
+#include "spotifyresults.h"
 #include "vcplugin.h"
 
 class VCSpotify final : public VCPlugin {
@@ -30,13 +33,13 @@ class VCSpotify final : public VCPlugin {
     Q_PROPERTY(int trackPosition                                    READ trackPosition     NOTIFY trackPositionChanged)
     Q_PROPERTY(int trackDuration                                    READ trackDuration     NOTIFY trackDurationChanged)
     Q_PROPERTY(QString playlistName                                 READ playlistName      NOTIFY playlistNameChanged)
-    Q_PROPERTY(QVariantList playlists                               READ playlists         NOTIFY playlistsChanged)
+    Q_PROPERTY(SpotifyResults * playlists                           READ playlists         CONSTANT)
     Q_PROPERTY(QString deviceName                                   READ deviceName        NOTIFY deviceNameChanged)
     Q_PROPERTY(QString deviceType                                   READ deviceType        NOTIFY deviceTypeChanged)
     Q_PROPERTY(int deviceVolume                                     READ deviceVolume      NOTIFY deviceVolumeChanged)
     Q_PROPERTY(QVariantList devices                                 READ devices           NOTIFY devicesChanged)
     Q_PROPERTY(QString preferredDevice     MEMBER preferredDevice_  READ preferredDevice   NOTIFY preferredDeviceChanged)
-    Q_PROPERTY(QVariantList searchResults                           READ searchResults     NOTIFY searchResultsChanged)
+    Q_PROPERTY(SpotifyResults * searchResults                       READ searchResults     CONSTANT)
     Q_PROPERTY(QString clientID            MEMBER clientID_                                NOTIFY clientIDChanged)
     Q_PROPERTY(QString clientSecret        MEMBER clientSecret_                            NOTIFY clientSecretChanged)
     Q_PROPERTY(QString refreshToken        MEMBER refreshToken_                            NOTIFY refreshTokenChanged)
@@ -61,12 +64,12 @@ class VCSpotify final : public VCPlugin {
     int trackPosition() const { return trackPosition_; }
     int trackDuration() const { return trackDuration_; }
     const QString& playlistName() const { return playlistName_; }
-    const QVariantList& playlists() const { return playlists_; }
+    SpotifyResults* playlists() const { return playlists_; }
     const QString& deviceName() const { return deviceName_; }
     const QString& deviceType() const { return deviceType_; }
     const QVariantList& devices() const { return devices_; }
     const QString& preferredDevice() const { return preferredDevice_; }
-    const QVariantList& searchResults() const { return searchResults_; }
+    SpotifyResults* searchResults() const { return searchResults_; }
     int deviceVolume() const { return deviceVolume_; }
 
     Q_INVOKABLE void play(const QString& uri = {});
@@ -100,13 +103,11 @@ class VCSpotify final : public VCPlugin {
     void trackPositionChanged();
     void trackDurationChanged();
     void playlistNameChanged();
-    void playlistsChanged();
     void deviceNameChanged();
     void deviceTypeChanged();
     void deviceVolumeChanged();
     void devicesChanged();
     void preferredDeviceChanged();
-    void searchResultsChanged();
     void clientIDChanged();
     void clientSecretChanged();
     void refreshTokenChanged();
@@ -119,9 +120,28 @@ class VCSpotify final : public VCPlugin {
 
  private slots:
     void handleNetworkReply(int statusCode, QObject* sender, const QJsonDocument& body);
+    void handleCredentialsChanged();
     void refreshAccessToken();
+    void runSyncCycle();
 
  private:
+    // Refreshes are collected into sync cycles, which skip whatever is still fresh or already covered by the playback
+    // reply, send the rest together, and leave anything over the per-cycle budget for the next cycle.
+    enum SyncResource {
+        PlaybackSync = 0,  // In priority order
+        DevicesSync,
+        PlaylistsSync,
+        UserProfileSync,
+        SyncResourceCount,
+    };
+
+    struct SyncState {
+        int maxAge = 0;  // Milliseconds
+        QElapsedTimer lastSync;
+        bool isWanted = false;
+        bool isForced = false;  // Send even if fresh
+    };
+
     QString userName_;
     QString userEmail_;
     QString userSubscription_;
@@ -138,14 +158,17 @@ class VCSpotify final : public VCPlugin {
     int trackPosition_;
     int trackDuration_;
     QString playlistName_;
-    QVariantList playlists_;
+    QString playlistURI_;
+    SpotifyResults* playlists_;  // Entries with: name, uri, isPublic, trackCount, image
     QString deviceName_;
     QString deviceType_;
     int deviceVolume_;
     QVariantList devices_;
     QString preferredDevice_;
     QString preferredDeviceID_;
-    QVariantList searchResults_;
+    QString activeDeviceID_;  // From the last playback reply
+    SpotifyResults* searchResults_;  // Entries with: name, uri, artist, album, image
+    QString searchQuery_;
     QString clientID_;
     QString clientSecret_;
     QString refreshToken_;
@@ -155,12 +178,32 @@ class VCSpotify final : public VCPlugin {
     QString market_;
     QByteArray accessTokenAuthorization_;
     QTimer accessTokenRefreshTimer_;
+    QObject* tokenRequester_;          // Sender of token requests, to tell their replies apart
+    QElapsedTimer tokenRequestTime_;   // Since the token request in flight was sent
+    QElapsedTimer tokenExchangeTime_;  // Since the last token was received from an exchange
     QTimer inactivityTimer_;
     QTimer actionSubmissionTimer_;
-
+    SyncState syncStates_[SyncResourceCount];
+    QTimer syncTimer_;
+    QTimer searchTimer_;
+    QElapsedTimer callClock_;
+    QQueue<qint64> callTimes_;  // Milliseconds on the clock, over the last minute
+
+    void handleTokenReply(int statusCode, const QJsonDocument& body);
+    void applyAccessToken(const QString& token, const QString& type, qint64 expiry);
+    bool isRefreshingToken() const;
+    QByteArray credentialsHash() const;
+    QString tokenCachePath() const;
+    bool loadTokenCache();
+    void saveTokenCache(qint64 expiry) const;
+    void requestSync(SyncResource resource, bool force = false);
+    bool isDeviceListCurrent() const;
+    void countCall();
+    int callsPerMinute();
     void sendRequest(const QUrl& destination,
                      QNetworkAccessManager::Operation requestType = QNetworkAccessManager::GetOperation,
-                     const QJsonDocument& body = QJsonDocument());
+                     const QJsonDocument& body = QJsonDocument(),
+                     QObject* sender = nullptr);
 
     Q_DISABLE_COPY_MOVE(VCSpotify)
 };
@@ -1,14 +1,26 @@
 #include "vcweather.h"
 
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
 #include <QJsonArray>
-#include <QJsonObject>
+#include <QSaveFile>
+#include <QStandardPaths>
 
+#include "logging.h"
 #include "networkinterface.h"
-#include "vchub.h"
+#include "timeformatter.h"
 /*--------------------------------------------------------------------------------------------------------------------*/
 
 namespace {
 constexpr int MAX_FORECAST_HOURS = 6;
+constexpr qint64 STALENESS_MARGIN = 30 * 1000;  // Allow for timers firing a little early
+
+QString forecastIconKey(const QJsonObject& forecastObject) {
+    // Only be concerned with the first value in the array.
+    const QJsonArray weatherArray = forecastObject.value("weather").toArray();
+    return weatherArray.isEmpty() ? QString() : weatherArray.first().toObject().value("icon").toString();
+}
 }  // namespace
 /*--------------------------------------------------------------------------------------------------------------------*/
 
@@ -19,13 +31,31 @@ VCWeather::VCWeather(const QString& name, QObject* parent)
       currentTemperature_(qQNaN()),
       currentFeelsLike_(qQNaN()),
       currentHumidity_(0),
-      currentWindSpeed_(qQNaN()) {
+      currentWindSpeed_(qQNaN()),
+      hourlyForecast_(new WeatherForecast(WeatherForecast::Interval::Hourly, this)),
+      dailyForecast_(new WeatherForecast(WeatherForecast::Interval::Daily, this)),
+      cachedLatitude_(qQNaN()),
+      cachedLongitude_(qQNaN()) {
     setUpdateInterval(5 * 60 * 1000);
     updateTimer_.stop();
 
+    // Refresh as soon as cached weather goes stale.
+    staleTimer_.setSingleShot(true);
+    connect(&staleTimer_, &QTimer::timeout, this, &VCWeather::refresh);
+
+    // Show the last known weather right away, until it can be refreshed.
+    loadCache();
+
     // Handle network responses.
     connect(NetworkInterface::instance(), &NetworkInterface::jsonReplyReceived, this, &VCWeather::handleNetworkReply);
 
+    // Redisplay the times that depend on the clock mode when it changes.
+    TimeFormatter::instance()->subscribe(this, [this] {
+        emit sunriseTimeChanged();
+        emit sunsetTimeChanged();
+        hourlyForecast_->refreshTimeLabels();
+    });
+
     // Update the URL whenever dependent properties change.
     connect(this, &VCWeather::latitudeChanged, this, &VCWeather::updateDestinationURL);
     connect(this, &VCWeather::longitudeChanged, this, &VCWeather::updateDestinationURL);
@@ -34,7 +64,7 @@ VCWeather::VCWeather(const QString& name, QObject* parent)
 /*--------------------------------------------------------------------------------------------------------------------*/
 
 QString VCWeather::localHour(const QDateTime& dateTime) const {
-    return dateTime.toString(VCHub::instance()->use24HourClock() ? "hh:00" : "h AP");
+    return TimeFormatter::instance()->hour(dateTime);
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
 
@@ -48,6 +78,11 @@ QUrl VCWeather::iconURL(const QString& key) const {
 /*--------------------------------------------------------------------------------------------------------------------*/
 
 void VCWeather::refresh() {
+    if (msecsUntilStale() > 0) {
+        // Still fresh, likely from the cache. Save the API call.
+        return;
+    }
+
 #ifndef QT_DEBUG
     // BDP: Be mindful of the API rate limits.
     NetworkInterface::instance()->sendJSONRequest(destination_, this);
@@ -61,15 +96,29 @@ void VCWeather::handleNetworkReply(int statusCode, QObject* sender, const QJsonD
         return;
     }
     if (statusCode != 200) {
-        qDebug() << "Ignoring unsuccessful reply from weather server with status code: " << statusCode;
+        qCWarning(lcWeather) << "Ignoring unsuccessful reply from weather server with status code: " << statusCode;
         return;
     }
     if (!body.isObject()) {
-        qDebug() << "Failed to parse response from weather server";
+        qCWarning(lcWeather) << "Failed to parse response from weather server";
         return;
     }
 
     QJsonObject responseObject = body.object();
+    applyResponse(responseObject);
+
+    lastUpdated_ = QDateTime::currentDateTime();
+    cachedLatitude_ = latitude_;
+    cachedLongitude_ = longitude_;
+    emit lastUpdatedChanged();
+    saveCache(responseObject);
+
+    // Count the next update interval from now.
+    updateTimer_.start();
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void VCWeather::applyResponse(const QJsonObject& responseObject) {
     if (responseObject.contains("current")) {
         QJsonObject currentObject = responseObject.value("current").toObject();
         if (currentObject.contains("temp")) {
@@ -137,70 +186,40 @@ void VCWeather::handleNetworkReply(int statusCode, QObject* sender, const QJsonD
         }
     }
     if (responseObject.contains("hourly")) {
-        hourlyForecast_.clear();
+        QVector<WeatherForecast::Entry> hourlyForecast;
 
         // Build the model with basic forecast information.
         const QJsonArray hourlyArray = responseObject.value("hourly").toArray();
-        for (int i = 0, total = qMin(MAX_FORECAST_HOURS, hourlyArray.size()); i < total; i++) {
+        int total = qMin(MAX_FORECAST_HOURS, hourlyArray.size());
+        hourlyForecast.reserve(total);
+        for (int i = 0; i < total; i++) {
             QJsonObject hourObject = hourlyArray.at(i).toObject();
-            QVariantMap hourForecast;
-
-            if (hourObject.contains("dt")) {
-                hourForecast.insert("time", QDateTime::fromSecsSinceEpoch(hourObject.value("dt").toInt()));
-            }
-            if (hourObject.contains("temp")) {
-                hourForecast.insert("temperature", hourObject.value("temp").toDouble());
-            }
-            if (hourObject.contains("weather")) {
-                QJsonArray weatherArray = hourObject.value("weather").toArray();
-                if (!weatherArray.isEmpty()) {
-                    QJsonObject weatherObject = weatherArray.first().toObject();
-                    if (weatherObject.contains("icon")) {
-                        hourForecast.insert("iconKey", weatherObject.value("icon").toString());
-                    }
-                }
-            }
-
-            hourlyForecast_.append(hourForecast);
+            hourlyForecast.append(WeatherForecast::Entry{hourObject.value("dt").toVariant().toLongLong(),
+                                                         forecastIconKey(hourObject),
+                                                         hourObject.value("temp").toDouble(qQNaN()),
+                                                         qQNaN(),
+                                                         qQNaN()});
         }
 
-        emit hourlyForecastChanged();
+        (void)hourlyForecast_->update(hourlyForecast);
     }
     if (responseObject.contains("daily")) {
-        dailyForecast_.clear();
+        QVector<WeatherForecast::Entry> dailyForecast;
 
         // Build the model with basic forecast information.
         const QJsonArray dailyArray = responseObject.value("daily").toArray();
+        dailyForecast.reserve(dailyArray.size());
         for (const auto& day : dailyArray) {
             QJsonObject dayObject = day.toObject();
-            QVariantMap dayForecast;
-
-            if (dayObject.contains("dt")) {
-                dayForecast.insert("time", QDateTime::fromSecsSinceEpoch(dayObject.value("dt").toInt()));
-            }
-            if (dayObject.contains("temp")) {
-                QJsonObject tempObject = dayObject.value("temp").toObject();
-                if (tempObject.contains("min")) {
-                    dayForecast.insert("minTemperature", tempObject.value("min").toDouble());
-                }
-                if (tempObject.contains("max")) {
-                    dayForecast.insert("maxTemperature", tempObject.value("max").toDouble());
-                }
-            }
-            if (dayObject.contains("weather")) {
-                QJsonArray weatherArray = dayObject.value("weather").toArray();
-                if (!weatherArray.isEmpty()) {
-                    QJsonObject weatherObject = weatherArray.first().toObject();
-                    if (weatherObject.contains("icon")) {
-                        dayForecast.insert("iconKey", weatherObject.value("icon").toString());
-                    }
-                }
-            }
-
-            dailyForecast_.append(dayForecast);
+            QJsonObject tempObject = dayObject.value("temp").toObject();
+            dailyForecast.append(WeatherForecast::Entry{dayObject.value("dt").toVariant().toLongLong(),
+                                                        forecastIconKey(dayObject),
+                                                        qQNaN(),
+                                                        tempObject.value("min").toDouble(qQNaN()),
+                                                        tempObject.value("max").toDouble(qQNaN())});
         }
 
-        emit dailyForecastChanged();
+        (void)dailyForecast_->update(dailyForecast);
     }
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
@@ -216,9 +235,84 @@ void VCWeather::updateDestinationURL() {
                             .arg(latitude_)
                             .arg(longitude_)
                             .arg(apiKey_));
+    NetworkInterface::instance()->addKnownHost(destination_);
 
-    // With everything needed to make requests collected, start the update timer and refesh immediately.
+    // With everything needed to make requests collected, start the update timer. Refresh immediately unless the cached
+    // weather is still fresh, in which case refresh as soon as it goes stale.
     updateTimer_.start();
-    refresh();
+    qint64 remaining = msecsUntilStale();
+    if (remaining > 0) {
+        staleTimer_.start(static_cast<int>(remaining));
+    } else {
+        refresh();
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+qint64 VCWeather::msecsUntilStale() const {
+    if (!lastUpdated_.isValid() || (cachedLatitude_ != latitude_) || (cachedLongitude_ != longitude_)) {
+        // Nothing for this location.
+        return 0;
+    }
+
+    qint64 age = lastUpdated_.msecsTo(QDateTime::currentDateTime());
+    if (age < 0) {
+        // The clock moved backwards, don't trust it.
+        return 0;
+    }
+    return qMax<qint64>(0, (updateInterval_ - STALENESS_MARGIN) - age);
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+QString VCWeather::cachePath() const {
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).filePath("weather.json");
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void VCWeather::loadCache() {
+    QFile file(cachePath());
+    if (!file.open(QIODevice::ReadOnly)) {
+        // Nothing cached yet.
+        return;
+    }
+
+    QJsonObject cacheObject = QJsonDocument::fromJson(file.readAll()).object();
+    QDateTime lastUpdated = QDateTime::fromMSecsSinceEpoch(cacheObject.value("lastUpdated").toVariant().toLongLong());
+    QJsonObject responseObject = cacheObject.value("response").toObject();
+    if (!cacheObject.contains("lastUpdated") || responseObject.isEmpty()) {
+        qCWarning(lcWeather) << "Ignoring invalid weather cache: " << file.fileName();
+        return;
+    }
+
+    applyResponse(responseObject);
+    lastUpdated_ = lastUpdated;
+    cachedLatitude_ = cacheObject.value("latitude").toDouble(qQNaN());
+    cachedLongitude_ = cacheObject.value("longitude").toDouble(qQNaN());
+    emit lastUpdatedChanged();
+    qCInfo(lcWeather) << "Loaded cached weather from: " << lastUpdated_;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void VCWeather::saveCache(const QJsonObject& responseObject) const {
+    QJsonObject cacheObject{{"lastUpdated", lastUpdated_.toMSecsSinceEpoch()},
+                            {"latitude", cachedLatitude_},
+                            {"longitude", cachedLongitude_},
+                            {"response", responseObject}};
+
+    QString path = cachePath();
+    if (!QDir().mkpath(QFileInfo(path).absolutePath())) {
+        qCWarning(lcWeather) << "Failed to create directory for weather cache: " << path;
+        return;
+    }
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(lcWeather) << "Failed to open weather cache: " << path;
+        return;
+    }
+    file.write(QJsonDocument(cacheObject).toJson(QJsonDocument::Compact));
+    if (!file.commit()) {
+        qCWarning(lcWeather) << "Failed to write weather cache: " << path;
+    }
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
@@ -3,9 +3,11 @@
 
 #include <QDateTime>
 #include <QJsonDocument>
+#include <QJsonObject>
 #include <QUrl>
 
 #include "vcplugin.h"
+#include "weatherforecast.h"
 
 class VCWeather final : public VCPlugin {
     Q_OBJECT
@@ -21,8 +23,9 @@ class VCWeather final : public VCPlugin {
     Q_PROPERTY(QString currentIconKey                          READ currentIconKey      NOTIFY currentIconKeyChanged)
     Q_PROPERTY(QDateTime sunriseTime                           READ sunriseTime         NOTIFY sunriseTimeChanged)
     Q_PROPERTY(QDateTime sunsetTime                            READ sunsetTime          NOTIFY sunsetTimeChanged)
-    Q_PROPERTY(QVariantList hourlyForecast                     READ hourlyForecast      NOTIFY hourlyForecastChanged)
-    Q_PROPERTY(QVariantList dailyForecast                      READ dailyForecast       NOTIFY dailyForecastChanged)
+    Q_PROPERTY(WeatherForecast * hourlyForecast                READ hourlyForecast      CONSTANT)
+    Q_PROPERTY(WeatherForecast * dailyForecast                 READ dailyForecast       CONSTANT)
+    Q_PROPERTY(QDateTime lastUpdated                           READ lastUpdated         NOTIFY lastUpdatedChanged)
     Q_PROPERTY(QString apiKey               MEMBER apiKey_                              NOTIFY apiKeyChanged)
     // clang-format on
 
@@ -40,8 +43,9 @@ class VCWeather final : public VCPlugin {
     const QString& currentIconKey() const { return currentIconKey_; }
     const QDateTime& sunriseTime() const { return sunriseTime_; }
     const QDateTime& sunsetTime() const { return sunsetTime_; }
-    const QVariantList& hourlyForecast() const { return hourlyForecast_; }
-    const QVariantList& dailyForecast() const { return dailyForecast_; }
+    WeatherForecast* hourlyForecast() const { return hourlyForecast_; }
+    WeatherForecast* dailyForecast() const { return dailyForecast_; }
+    const QDateTime& lastUpdated() const { return lastUpdated_; }
 
     Q_INVOKABLE QString localHour(const QDateTime& dateTime) const;
     Q_INVOKABLE QUrl iconURL(const QString& key) const;
@@ -61,8 +65,7 @@ class VCWeather final : public VCPlugin {
     void currentIconKeyChanged();
     void sunriseTimeChanged();
     void sunsetTimeChanged();
-    void hourlyForecastChanged();
-    void dailyForecastChanged();
+    void lastUpdatedChanged();
     void apiKeyChanged();
 
  private slots:
@@ -81,11 +84,21 @@ class VCWeather final : public VCPlugin {
     QString currentIconKey_;
     QDateTime sunriseTime_;
     QDateTime sunsetTime_;
-    QVariantList hourlyForecast_;  // List of maps containing: time, iconKey, temperate
-    QVariantList dailyForecast_;   // List of maps containing: time, iconKey, minTemperature, maxTemperature
+    WeatherForecast* hourlyForecast_;  // Entries with: time, iconKey, temperature
+    WeatherForecast* dailyForecast_;   // Entries with: time, iconKey, minTemperature, maxTemperature
+    QDateTime lastUpdated_;
     QString apiKey_;
 
     QUrl destination_;
+    double cachedLatitude_;   // Location of the cached response
+    double cachedLongitude_;
+    QTimer staleTimer_;
+
+    void applyResponse(const QJsonObject& responseObject);
+    qint64 msecsUntilStale() const;
+    QString cachePath() const;
+    void loadCache();
+    void saveCache(const QJsonObject& responseObject) const;
 
     Q_DISABLE_COPY_MOVE(VCWeather)
 };
@@ -0,0 +1,134 @@
+#include "weatherforecast.h"
+
+#include <QDateTime>
+#include <QtMath>
+
+#include "timeformatter.h"
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+namespace {
+bool sameTemperature(const double left, const double right) {
+    // NaN never compares equal, but an unused temperature has not changed.
+    return (left == right) || (qIsNaN(left) && qIsNaN(right));
+}
+}  // namespace
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+WeatherForecast::WeatherForecast(const Interval interval, QObject* parent)
+    : QAbstractListModel(parent), interval_(interval) {
+    // Nothing else to do.
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int WeatherForecast::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : entries_.size();
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+QVariant WeatherForecast::data(const QModelIndex& index, const int role) const {
+    if (!index.isValid() || (index.row() >= entries_.size())) {
+        return QVariant();
+    }
+
+    const Entry& entry = entries_.at(index.row());
+    switch (role) {
+        case TimeRole:
+            return QDateTime::fromSecsSinceEpoch(entry.time);
+
+        case TimeLabelRole: {
+            QDateTime dateTime = QDateTime::fromSecsSinceEpoch(entry.time);
+            return (interval_ == Interval::Hourly) ? TimeFormatter::instance()->hour(dateTime)
+                                                   : dateTime.toString("dddd");
+        }
+
+        case IconKeyRole:
+            return entry.iconKey;
+
+        case TemperatureRole:
+            return entry.temperature;
+
+        case MinTemperatureRole:
+            return entry.minTemperature;
+
+        case MaxTemperatureRole:
+            return entry.maxTemperature;
+
+        default:
+            return QVariant();
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+QHash<int, QByteArray> WeatherForecast::roleNames() const {
+    return {{TimeRole, "time"},
+            {TimeLabelRole, "timeLabel"},
+            {IconKeyRole, "iconKey"},
+            {TemperatureRole, "temperature"},
+            {MinTemperatureRole, "minTemperature"},
+            {MaxTemperatureRole, "maxTemperature"}};
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+bool WeatherForecast::update(const QVector<Entry>& entries) {
+    bool changed = false;
+
+    // Update the rows that exist in both in place, so delegates are only touched where the forecast changed.
+    for (int i = 0, total = qMin(entries_.size(), entries.size()); i < total; i++) {
+        QVector<int> roles = changedRoles(entries_.at(i), entries.at(i));
+        if (!roles.isEmpty()) {
+            entries_[i] = entries.at(i);
+            QModelIndex modelIndex = index(i);
+            emit dataChanged(modelIndex, modelIndex, roles);
+            changed = true;
+        }
+    }
+
+    // Then trim or extend the tail.
+    if (entries_.size() > entries.size()) {
+        beginRemoveRows(QModelIndex(), entries.size(), entries_.size() - 1);
+        entries_.resize(entries.size());
+        endRemoveRows();
+        emit countChanged();
+        changed = true;
+    } else if (entries_.size() < entries.size()) {
+        beginInsertRows(QModelIndex(), entries_.size(), entries.size() - 1);
+        for (int i = entries_.size(); i < entries.size(); i++) {
+            entries_.append(entries.at(i));
+        }
+        endInsertRows();
+        emit countChanged();
+        changed = true;
+    }
+
+    return changed;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void WeatherForecast::refreshTimeLabels() {
+    if (!entries_.isEmpty()) {
+        emit dataChanged(index(0), index(entries_.size() - 1), {TimeLabelRole});
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+QVector<int> WeatherForecast::changedRoles(const Entry& previous, const Entry& current) {
+    QVector<int> roles;
+    if (previous.time != current.time) {
+        roles.append(TimeRole);
+        roles.append(TimeLabelRole);
+    }
+    if (previous.iconKey != current.iconKey) {
+        roles.append(IconKeyRole);
+    }
+    if (!sameTemperature(previous.temperature, current.temperature)) {
+        roles.append(TemperatureRole);
+    }
+    if (!sameTemperature(previous.minTemperature, current.minTemperature)) {
+        roles.append(MinTemperatureRole);
+    }
+    if (!sameTemperature(previous.maxTemperature, current.maxTemperature)) {
+        roles.append(MaxTemperatureRole);
+    }
+    return roles;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
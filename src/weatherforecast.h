@@ -0,0 +1,63 @@
+#ifndef WEATHERFORECAST_H_
+#define WEATHERFORECAST_H_
+
+#include <QAbstractListModel>
+#include <QString>
+#include <QVector>
+
+class WeatherForecast final : public QAbstractListModel {
+    Q_OBJECT
+
+    // clang-format off
+    Q_PROPERTY(int count  READ count  NOTIFY countChanged)
+    // clang-format on
+
+ public:
+    enum class Interval {
+        Hourly,
+        Daily,
+    };
+
+    enum Roles {
+        TimeRole = Qt::UserRole + 1,
+        TimeLabelRole,
+        IconKeyRole,
+        TemperatureRole,
+        MinTemperatureRole,
+        MaxTemperatureRole,
+    };
+
+    // Temperatures which are not part of the forecast are left as NaN.
+    struct Entry {
+        qint64 time;  // Seconds since epoch
+        QString iconKey;
+        double temperature;
+        double minTemperature;
+        double maxTemperature;
+    };
+
+    explicit WeatherForecast(Interval interval, QObject* parent = nullptr);
+
+    int count() const { return entries_.size(); }
+    const QVector<Entry>& entries() const { return entries_; }
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    bool update(const QVector<Entry>& entries);
+    void refreshTimeLabels();
+
+ signals:
+    void countChanged();
+
+ private:
+    Interval interval_;
+    QVector<Entry> entries_;
+
+    static QVector<int> changedRoles(const Entry& previous, const Entry& current);
+
+    Q_DISABLE_COPY_MOVE(WeatherForecast)
+};
+
+#endif  // WEATHERFORECAST_H_
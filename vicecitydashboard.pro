@@ -1,8 +1,9 @@
-QT += charts network quick virtualkeyboard widgets
+QT += charts concurrent network quick virtualkeyboard widgets
 
 CONFIG += c++11
 
 CONFIG(release, debug|release):CONFIG += qtquickcompiler
+CONFIG(release, debug|release):DEFINES += QT_NO_DEBUG_OUTPUT
 
 !defined(VERSION,var):{ VERSION=1.0.0 }
 DEFINES += APPLICATION_VERSION=\"\\\"$${VERSION}\\\"\"
@@ -14,12 +15,28 @@ QMAKE_CXXFLAGS += -Werror
 unix:!macx: QMAKE_CXXFLAGS += -Wno-psabi
 
 SOURCES += \
+        src/addressmonitor.cpp \
+        src/commandtracker.cpp \
         src/hueambiancelight.cpp \
         src/huecolorlight.cpp \
         src/huedevice.cpp \
         src/huelight.cpp \
+        src/logging.cpp \
         src/main.cpp \
+        src/memorymonitor.cpp \
+        src/metrics.cpp \
+        src/nanoleafeffects.cpp \
+        src/nanoleaflayout.cpp \
+        src/nanoleafstream.cpp \
+        src/networkcapture.cpp \
         src/networkinterface.cpp \
+        src/numberformatter.cpp \
+        src/pluginviewer.cpp \
+        src/profiler.cpp \
+        src/scriptdriver.cpp \
+        src/spotifyresults.cpp \
+        src/startupprofiler.cpp \
+        src/timeformatter.cpp \
         src/vcconfig.cpp \
         src/vcfacts.cpp \
         src/vchub.cpp \
@@ -28,14 +45,31 @@ SOURCES += \
         src/vcpihole.cpp \
         src/vcplugin.cpp \
         src/vcspotify.cpp \
-        src/vcweather.cpp
+        src/vcweather.cpp \
+        src/weatherforecast.cpp
 
 HEADERS += \
+    src/addressmonitor.h \
+    src/commandtracker.h \
     src/hueambiancelight.h \
     src/huecolorlight.h \
     src/huedevice.h \
     src/huelight.h \
+    src/logging.h \
+    src/memorymonitor.h \
+    src/metrics.h \
+    src/nanoleafeffects.h \
+    src/nanoleaflayout.h \
+    src/nanoleafstream.h \
+    src/networkcapture.h \
     src/networkinterface.h \
+    src/numberformatter.h \
+    src/pluginviewer.h \
+    src/profiler.h \
+    src/scriptdriver.h \
+    src/spotifyresults.h \
+    src/startupprofiler.h \
+    src/timeformatter.h \
     src/vcconfig.h \
     src/vcfacts.h \
     src/vchub.h \
@@ -44,7 +78,8 @@ HEADERS += \
     src/vcpihole.h \
     src/vcplugin.h \
     src/vcspotify.h \
-    src/vcweather.h
+    src/vcweather.h \
+    src/weatherforecast.h
 
 RESOURCES += qml/qml.qrc \
     resources/resources.qrc